@@ -0,0 +1,281 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Acknowledged bulk transfer over CAN. The sender announces the buffer with
+ * CAN_PACKET_BULK_START:
+ *
+ * [sender, commands_send, len_hi, len_lo, crc_hi, crc_lo]
+ *
+ * and sends it in CAN_PACKET_BULK_DATA frames of 6 bytes:
+ *
+ * [sender, seq | CAN_BULK_SEQ_ACK_REQ, data...]
+ *
+ * The receiver answers the start frame, frames with CAN_BULK_SEQ_ACK_REQ set
+ * and the completion of the buffer with CAN_PACKET_BULK_ACK:
+ *
+ * [receiver, status, base, trigger, bitmap_0, bitmap_1, bitmap_2]
+ *
+ * where base is the first missing frame, trigger the frame that caused the
+ * ack and bit i of the bitmap tells if frame base + i has been received. The
+ * sender keeps at most CAN_BULK_WINDOW frames ahead of base, asks for an ack
+ * every CAN_BULK_ACK_INTERVAL frames and only sends the frames the ack reports
+ * as missing again. The ack interval is shorter than the window, so the window
+ * moves on before the sender runs out of frames to send.
+ *
+ * This file holds the window and ack bookkeeping of both ends. Sending frames,
+ * waiting for acks and the start handshake are done in comm_can.c, so that
+ * this can be run against a simulated bus on the host (see tests/can_bulk).
+ */
+
+#include "can_bulk.h"
+
+#include <string.h>
+
+// Private functions
+static bool bit_get(const uint32_t *bits, int i);
+static void bit_set(uint32_t *bits, int i);
+
+/**
+ * Start sending a buffer, after the receiver has answered the start frame.
+ *
+ * @param tx
+ * Transfer state.
+ *
+ * @param len
+ * Length of the buffer, at most CAN_BULK_BUFFER_SIZE.
+ *
+ * @param send
+ * Function that sends data frame seq of the buffer.
+ *
+ * @param arg
+ * Argument for send.
+ */
+void can_bulk_tx_init(can_bulk_tx *tx, unsigned int len,
+		void (*send)(void *arg, int seq, bool ack_req), void *arg) {
+	memset(tx, 0, sizeof(can_bulk_tx));
+	tx->frames = (len + 5) / 6;
+	tx->send = send;
+	tx->arg = arg;
+}
+
+/**
+ * Send the frames that fit in the window. Call this before waiting for every
+ * ack.
+ *
+ * @param tx
+ * Transfer state.
+ */
+void can_bulk_tx_send_window(can_bulk_tx *tx) {
+	while (tx->next < tx->frames && tx->next < (tx->base + CAN_BULK_WINDOW)) {
+		bool ack_req = (tx->next + 1) == tx->frames ||
+				((tx->next + 1) % CAN_BULK_ACK_INTERVAL) == 0;
+		tx->send(tx->arg, tx->next, ack_req);
+		tx->next++;
+	}
+}
+
+/**
+ * Handle an ack from the receiver and send the frames it reports as missing
+ * again.
+ *
+ * @param tx
+ * Transfer state.
+ *
+ * @param ack
+ * The CAN_BULK_ACK_LEN bytes of the ack frame.
+ *
+ * @return
+ * CAN_BULK_TX_RUNNING to continue with can_bulk_tx_send_window,
+ * CAN_BULK_TX_DONE when the receiver has the buffer and CAN_BULK_TX_FAILED
+ * when the transfer should be given up.
+ */
+CAN_BULK_TX_RES can_bulk_tx_ack(can_bulk_tx *tx, const uint8_t *ack) {
+	if (ack[1] == CAN_BULK_STATUS_DONE) {
+		return CAN_BULK_TX_DONE;
+	} else if (ack[1] != CAN_BULK_STATUS_RUNNING) {
+		return CAN_BULK_TX_FAILED;
+	}
+
+	int ack_base = ack[2];
+	int trigger = ack[3];
+	uint32_t bitmap = (uint32_t)ack[4] | ((uint32_t)ack[5] << 8) | ((uint32_t)ack[6] << 16);
+
+	for (int i = 0;i < ack_base && i < tx->frames;i++) {
+		bit_set(tx->acked, i);
+	}
+
+	for (int i = 0;i < 24 && (ack_base + i) < tx->frames;i++) {
+		if (bitmap & (1 << i)) {
+			bit_set(tx->acked, ack_base + i);
+		}
+	}
+
+	if (ack_base > tx->base) {
+		tx->base = ack_base;
+		tx->retries = 0;
+	} else if (++tx->retries > CAN_BULK_RETRIES) {
+		return CAN_BULK_TX_FAILED;
+	}
+
+	// Send the frames up to the trigger that did not arrive again. Frames
+	// after the trigger may still be on the way.
+	int last_missing = -1;
+	for (int i = tx->base;i <= trigger && i < tx->next;i++) {
+		if (!bit_get(tx->acked, i)) {
+			last_missing = i;
+		}
+	}
+
+	for (int i = tx->base;i <= last_missing;i++) {
+		if (!bit_get(tx->acked, i)) {
+			tx->send(tx->arg, i, i == last_missing);
+		}
+	}
+
+	return CAN_BULK_TX_RUNNING;
+}
+
+/**
+ * Handle a missing ack. Either the ack or the frame asking for it was lost, so
+ * the last frame is sent again asking for an ack.
+ *
+ * @param tx
+ * Transfer state.
+ *
+ * @return
+ * CAN_BULK_TX_RUNNING to continue, or CAN_BULK_TX_FAILED after
+ * CAN_BULK_RETRIES timeouts in a row.
+ */
+CAN_BULK_TX_RES can_bulk_tx_timeout(can_bulk_tx *tx) {
+	if (++tx->retries > CAN_BULK_RETRIES) {
+		return CAN_BULK_TX_FAILED;
+	}
+
+	tx->send(tx->arg, tx->next - 1, true);
+	return CAN_BULK_TX_RUNNING;
+}
+
+/**
+ * Start receiving a buffer.
+ *
+ * @param rx
+ * Receive state.
+ *
+ * @param len
+ * Length of the buffer, at most CAN_BULK_BUFFER_SIZE.
+ */
+void can_bulk_rx_init(can_bulk_rx *rx, unsigned int len) {
+	rx->len = len;
+	rx->frames = (len + 5) / 6;
+	rx->status = CAN_BULK_STATUS_RUNNING;
+	memset(rx->received, 0, sizeof(rx->received));
+}
+
+/**
+ * Store a data frame. When the frame completes the buffer, the caller checks
+ * it and sets the status to CAN_BULK_STATUS_DONE or CAN_BULK_STATUS_ERROR
+ * before acking.
+ *
+ * @param rx
+ * Receive state.
+ *
+ * @param seq
+ * Frame number, without CAN_BULK_SEQ_ACK_REQ.
+ *
+ * @param data
+ * Data of the frame.
+ *
+ * @param len
+ * Length of the data.
+ *
+ * @return
+ * What became of the frame.
+ */
+CAN_BULK_RX_RES can_bulk_rx_data(can_bulk_rx *rx, int seq, const uint8_t *data, int len) {
+	if (seq >= rx->frames) {
+		return CAN_BULK_RX_IGNORED;
+	}
+
+	if (rx->status != CAN_BULK_STATUS_RUNNING) {
+		// The sender missed the final ack
+		return CAN_BULK_RX_FINISHED;
+	}
+
+	unsigned int offset = seq * 6;
+	unsigned int frame_len = (rx->len - offset) < 6 ? (rx->len - offset) : 6;
+	if (len < 0 || (unsigned int)len < frame_len) {
+		return CAN_BULK_RX_IGNORED;
+	}
+
+	memcpy(rx->buf + offset, data, frame_len);
+	bit_set(rx->received, seq);
+
+	for (int i = 0;i < rx->frames;i++) {
+		if (!bit_get(rx->received, i)) {
+			return CAN_BULK_RX_STORED;
+		}
+	}
+
+	return CAN_BULK_RX_COMPLETE;
+}
+
+/**
+ * Append the ack to a frame buffer, after the ID of the receiver.
+ *
+ * @param rx
+ * Receive state.
+ *
+ * @param trigger
+ * The frame that caused the ack.
+ *
+ * @param buffer
+ * Frame buffer.
+ *
+ * @param index
+ * Position in the buffer, advanced by CAN_BULK_ACK_LEN - 1.
+ */
+void can_bulk_rx_ack(const can_bulk_rx *rx, int trigger, uint8_t *buffer, int32_t *index) {
+	int base = 0;
+	while (base < rx->frames && bit_get(rx->received, base)) {
+		base++;
+	}
+
+	uint32_t bitmap = 0;
+	for (int i = 0;i < 24 && (base + i) < rx->frames;i++) {
+		if (bit_get(rx->received, base + i)) {
+			bitmap |= 1 << i;
+		}
+	}
+
+	buffer[(*index)++] = rx->status;
+	buffer[(*index)++] = base;
+	buffer[(*index)++] = trigger;
+	buffer[(*index)++] = bitmap & 0xFF;
+	buffer[(*index)++] = (bitmap >> 8) & 0xFF;
+	buffer[(*index)++] = (bitmap >> 16) & 0xFF;
+}
+
+static bool bit_get(const uint32_t *bits, int i) {
+	return bits[i >> 5] & (1u << (i & 31));
+}
+
+static void bit_set(uint32_t *bits, int i) {
+	bits[i >> 5] |= 1u << (i & 31);
+}
@@ -0,0 +1,83 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef CAN_BULK_H_
+#define CAN_BULK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "packet.h"
+
+// Settings
+#define CAN_BULK_WINDOW					24 // Frames in flight before an ack is needed, at most 24
+#define CAN_BULK_ACK_INTERVAL			12 // Frames between ack requests
+#define CAN_BULK_RETRIES				5
+
+// Protocol
+#define CAN_BULK_BUFFER_SIZE			PACKET_MAX_PL_LEN
+#define CAN_BULK_FRAMES_MAX				((CAN_BULK_BUFFER_SIZE + 5) / 6) // Must fit in 7 bits
+#define CAN_BULK_SEQ_ACK_REQ			0x80
+#define CAN_BULK_STATUS_RUNNING			0
+#define CAN_BULK_STATUS_DONE			1
+#define CAN_BULK_STATUS_ERROR			2
+#define CAN_BULK_ACK_LEN				7
+
+typedef enum {
+	CAN_BULK_TX_RUNNING = 0,
+	CAN_BULK_TX_DONE,
+	CAN_BULK_TX_FAILED
+} CAN_BULK_TX_RES;
+
+typedef enum {
+	CAN_BULK_RX_IGNORED = 0, // Not part of the buffer
+	CAN_BULK_RX_STORED,
+	CAN_BULK_RX_COMPLETE, // The frame completed the buffer
+	CAN_BULK_RX_FINISHED // The buffer was already complete
+} CAN_BULK_RX_RES;
+
+typedef struct {
+	int frames;
+	int base; // First frame that has not been acked
+	int next; // Next frame to send for the first time
+	int retries;
+	uint32_t acked[(CAN_BULK_FRAMES_MAX + 31) / 32];
+	// Sends data frame seq, asking for an ack if ack_req is set
+	void (*send)(void *arg, int seq, bool ack_req);
+	void *arg;
+} can_bulk_tx;
+
+typedef struct {
+	uint8_t buf[CAN_BULK_BUFFER_SIZE];
+	unsigned int len;
+	int frames;
+	int status;
+	uint32_t received[(CAN_BULK_FRAMES_MAX + 31) / 32];
+} can_bulk_rx;
+
+// Functions
+void can_bulk_tx_init(can_bulk_tx *tx, unsigned int len,
+		void (*send)(void *arg, int seq, bool ack_req), void *arg);
+void can_bulk_tx_send_window(can_bulk_tx *tx);
+CAN_BULK_TX_RES can_bulk_tx_ack(can_bulk_tx *tx, const uint8_t *ack);
+CAN_BULK_TX_RES can_bulk_tx_timeout(can_bulk_tx *tx);
+void can_bulk_rx_init(can_bulk_rx *rx, unsigned int len);
+CAN_BULK_RX_RES can_bulk_rx_data(can_bulk_rx *rx, int seq, const uint8_t *data, int len);
+void can_bulk_rx_ack(const can_bulk_rx *rx, int trigger, uint8_t *buffer, int32_t *index);
+
+#endif /* CAN_BULK_H_ */
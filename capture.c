@@ -0,0 +1,314 @@
+/*
+	Copyright 2021 - 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC Braking Resistor firmware.
+
+	The VESC Braking Resistor firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC Braking Resistor firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "ch.h"
+#include "hal.h"
+#include "capture.h"
+#include "datatypes.h"
+#include "buffer.h"
+#include "commands.h"
+#include "terminal.h"
+#include "utils.h"
+#include <stdlib.h>
+
+/*
+ * Transient capture. While armed, every sample from the ADC callback is
+ * written to a circular buffer. When a trigger fires, recording continues
+ * until the buffer holds the requested number of pre-trigger samples
+ * followed by the post-trigger samples, and the buffer is then frozen until
+ * it is armed again. The snapshot is downloaded in chunks with
+ * COMM_RES_CAPTURE.
+ */
+
+// Settings
+#define CAPTURE_LEN				1024
+#define CHUNK_MAX				50
+
+typedef struct {
+	uint16_t time_us;
+	int16_t v_in;
+	int16_t i_in;
+	uint16_t duty;
+} capture_sample_t;
+
+typedef enum {
+	CAPTURE_CMD_ARM = 0,
+	CAPTURE_CMD_STATUS,
+	CAPTURE_CMD_READ,
+	CAPTURE_CMD_TRIGGER
+} CAPTURE_CMD;
+
+// Private functions
+static void terminal_arm(int argc, const char **argv);
+static void terminal_status(int argc, const char **argv);
+
+// Private variables
+static capture_sample_t m_buffer[CAPTURE_LEN];
+static volatile CAPTURE_STATE m_state = CAPTURE_STATE_IDLE;
+static volatile uint8_t m_trig_mask = 0;
+static volatile uint8_t m_trig_source = 0;
+static volatile float m_v_thres = 0.0;
+static volatile float m_i_thres = 0.0;
+static volatile int m_pre_samples = CAPTURE_LEN / 4;
+static volatile int m_pos = 0;
+static volatile int m_filled = 0;
+static volatile int m_post_left = 0;
+
+void capture_init(void) {
+	terminal_register_command_callback(
+			"cap_arm",
+			"Arm transient capture. Triggers on input voltage above vin, current above "
+			"current, thermal limiting and PWM clamping. 0 disables the threshold.",
+			"[vin] [current]",
+			terminal_arm);
+
+	terminal_register_command_callback(
+			"cap_status",
+			"Print the transient capture state",
+			0,
+			terminal_status);
+}
+
+/**
+ * Record a sample. Called from the ADC interrupt.
+ *
+ * @param v_in
+ * Input voltage.
+ *
+ * @param i_in
+ * Input current.
+ *
+ * @param duty
+ * Duty cycle applied to the load.
+ */
+void capture_sample(float v_in, float i_in, float duty) {
+	if (m_state != CAPTURE_STATE_ARMED && m_state != CAPTURE_STATE_TRIGGERED) {
+		return;
+	}
+
+	capture_sample_t *s = &m_buffer[m_pos];
+	s->time_us = (uint16_t)(chSysGetRealtimeCounterX() / (SystemCoreClock / 1000000));
+	s->v_in = (int16_t)(v_in * 1e2);
+	s->i_in = (int16_t)(i_in * 1e2);
+	s->duty = (uint16_t)(duty * 1e4);
+
+	m_pos++;
+	if (m_pos == CAPTURE_LEN) {
+		m_pos = 0;
+	}
+
+	if (m_state == CAPTURE_STATE_ARMED) {
+		if (m_filled < m_pre_samples) {
+			m_filled++;
+			return;
+		}
+
+		if ((m_trig_mask & CAPTURE_TRIG_VIN) && v_in > m_v_thres) {
+			m_trig_source = CAPTURE_TRIG_VIN;
+		} else if ((m_trig_mask & CAPTURE_TRIG_CURRENT) && i_in > m_i_thres) {
+			m_trig_source = CAPTURE_TRIG_CURRENT;
+		}
+
+		if (m_trig_source) {
+			// The trigger sample is already stored
+			m_post_left = CAPTURE_LEN - m_pre_samples - 1;
+			m_state = m_post_left > 0 ? CAPTURE_STATE_TRIGGERED : CAPTURE_STATE_DONE;
+		}
+	} else {
+		m_post_left--;
+		if (m_post_left <= 0) {
+			m_state = CAPTURE_STATE_DONE;
+		}
+	}
+}
+
+/**
+ * Start recording and wait for a trigger. A previous snapshot is discarded.
+ *
+ * @param trig_mask
+ * Combination of CAPTURE_TRIG_ sources to trigger on.
+ *
+ * @param v_thres
+ * Input voltage threshold for CAPTURE_TRIG_VIN.
+ *
+ * @param i_thres
+ * Input current threshold for CAPTURE_TRIG_CURRENT.
+ *
+ * @param pre_samples
+ * Number of samples to keep from before the trigger.
+ */
+void capture_arm(uint8_t trig_mask, float v_thres, float i_thres, int pre_samples) {
+	utils_truncate_number_int(&pre_samples, 0, CAPTURE_LEN - 1);
+
+	chSysLock();
+	m_trig_mask = trig_mask;
+	m_trig_source = 0;
+	m_v_thres = v_thres;
+	m_i_thres = i_thres;
+	m_pre_samples = pre_samples;
+	m_filled = 0;
+	m_state = CAPTURE_STATE_ARMED;
+	chSysUnlock();
+}
+
+/**
+ * Fire a trigger. Ignored if the capture is not armed, if the source is not
+ * enabled or if the pre-trigger history has not been recorded yet. Can be
+ * called from threads and interrupts.
+ *
+ * @param source
+ * The CAPTURE_TRIG_ source.
+ */
+void capture_trigger(uint8_t source) {
+	syssts_t sts = chSysGetStatusAndLockX();
+	if (m_state == CAPTURE_STATE_ARMED && (m_trig_mask & source) &&
+			m_filled >= m_pre_samples) {
+		m_trig_source = source;
+		m_post_left = CAPTURE_LEN - m_pre_samples;
+		m_state = CAPTURE_STATE_TRIGGERED;
+	}
+	chSysRestoreStatusX(sts);
+}
+
+/*
+ * COMM_RES_CAPTURE handler. The first byte is a CAPTURE_CMD:
+ *
+ * ARM:     uint8 trigger mask, float32 vin threshold, float32 current threshold,
+ *          uint16 pre-trigger samples
+ * STATUS:  Replies with uint8 state, uint8 trigger source, uint16 length and
+ *          uint16 pre-trigger samples
+ * READ:    uint16 offset, uint8 count. Replies with the offset, the count and
+ *          the samples, oldest first. Only valid when the capture is done.
+ * TRIGGER: Fires a manual trigger
+ *
+ * Samples are encoded as uint16 timestamp in microseconds, int16 voltage * 100,
+ * int16 current * 100 and uint16 duty * 10000.
+ */
+void capture_process_packet(unsigned char *data, unsigned int len,
+		void(*reply_func)(unsigned char *data, unsigned int len)) {
+	if (len < 1) {
+		return;
+	}
+
+	int32_t ind = 0;
+	CAPTURE_CMD cmd = data[ind++];
+
+	switch (cmd) {
+	case CAPTURE_CMD_ARM: {
+		if (len < 12) {
+			break;
+		}
+
+		uint8_t mask = data[ind++];
+		float v_thres = buffer_get_float32_auto(data, &ind);
+		float i_thres = buffer_get_float32_auto(data, &ind);
+		int pre = buffer_get_uint16(data, &ind);
+		capture_arm(mask, v_thres, i_thres, pre);
+	} break;
+
+	case CAPTURE_CMD_STATUS: {
+		uint8_t send_buffer[10];
+		ind = 0;
+		send_buffer[ind++] = COMM_RES_CAPTURE;
+		send_buffer[ind++] = CAPTURE_CMD_STATUS;
+		send_buffer[ind++] = m_state;
+		send_buffer[ind++] = m_trig_source;
+		buffer_append_uint16(send_buffer, CAPTURE_LEN, &ind);
+		buffer_append_uint16(send_buffer, m_pre_samples, &ind);
+		reply_func(send_buffer, ind);
+	} break;
+
+	case CAPTURE_CMD_READ: {
+		if (m_state != CAPTURE_STATE_DONE || len < 4) {
+			break;
+		}
+
+		int offset = buffer_get_uint16(data, &ind);
+		int num = data[ind++];
+		if (num > CHUNK_MAX) {
+			num = CHUNK_MAX;
+		}
+		if ((offset + num) > CAPTURE_LEN) {
+			num = CAPTURE_LEN - offset;
+		}
+		if (num < 0) {
+			break;
+		}
+
+		static uint8_t send_buffer[6 + CHUNK_MAX * sizeof(capture_sample_t)];
+		ind = 0;
+		send_buffer[ind++] = COMM_RES_CAPTURE;
+		send_buffer[ind++] = CAPTURE_CMD_READ;
+		buffer_append_uint16(send_buffer, offset, &ind);
+		send_buffer[ind++] = num;
+
+		// The oldest sample is at the write position once the capture is done
+		for (int i = 0;i < num;i++) {
+			capture_sample_t *s = &m_buffer[(m_pos + offset + i) % CAPTURE_LEN];
+			buffer_append_uint16(send_buffer, s->time_us, &ind);
+			buffer_append_int16(send_buffer, s->v_in, &ind);
+			buffer_append_int16(send_buffer, s->i_in, &ind);
+			buffer_append_uint16(send_buffer, s->duty, &ind);
+		}
+
+		reply_func(send_buffer, ind);
+	} break;
+
+	case CAPTURE_CMD_TRIGGER:
+		capture_trigger(CAPTURE_TRIG_MANUAL);
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void terminal_arm(int argc, const char **argv) {
+	uint8_t mask = CAPTURE_TRIG_TEMP | CAPTURE_TRIG_CLAMP | CAPTURE_TRIG_MANUAL;
+	float v_thres = 0.0;
+	float i_thres = 0.0;
+
+	if (argc >= 2) {
+		v_thres = atof(argv[1]);
+	}
+	if (argc >= 3) {
+		i_thres = atof(argv[2]);
+	}
+
+	if (v_thres > 0.0) {
+		mask |= CAPTURE_TRIG_VIN;
+	}
+	if (i_thres > 0.0) {
+		mask |= CAPTURE_TRIG_CURRENT;
+	}
+
+	capture_arm(mask, v_thres, i_thres, CAPTURE_LEN / 4);
+	commands_printf("Capture armed\n");
+}
+
+static void terminal_status(int argc, const char **argv) {
+	(void)argc;
+	(void)argv;
+
+	const char *states[] = {"Idle", "Armed", "Triggered", "Done"};
+	commands_printf("State          : %s", states[m_state]);
+	commands_printf("Trigger mask   : 0x%02x", m_trig_mask);
+	commands_printf("Trigger source : 0x%02x", m_trig_source);
+	commands_printf("Length         : %d (%d before trigger)\n", CAPTURE_LEN, m_pre_samples);
+}
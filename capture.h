@@ -0,0 +1,49 @@
+/*
+	Copyright 2021 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC Braking Resistor firmware.
+
+	The VESC Braking Resistor firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC Braking Resistor firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Trigger sources, can be combined
+#define CAPTURE_TRIG_VIN		(1 << 0)
+#define CAPTURE_TRIG_CURRENT	(1 << 1)
+#define CAPTURE_TRIG_TEMP		(1 << 2)
+#define CAPTURE_TRIG_CLAMP		(1 << 3)
+#define CAPTURE_TRIG_MANUAL		(1 << 4)
+
+typedef enum {
+	CAPTURE_STATE_IDLE = 0,
+	CAPTURE_STATE_ARMED,
+	CAPTURE_STATE_TRIGGERED,
+	CAPTURE_STATE_DONE
+} CAPTURE_STATE;
+
+// Functions
+void capture_init(void);
+void capture_sample(float v_in, float i_in, float duty);
+void capture_arm(uint8_t trig_mask, float v_thres, float i_thres, int pre_samples);
+void capture_trigger(uint8_t source);
+void capture_process_packet(unsigned char *data, unsigned int len,
+		void(*reply_func)(unsigned char *data, unsigned int len));
+
+#endif /* CAPTURE_H_ */
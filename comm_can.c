@@ -27,39 +27,140 @@
 #include "timeout.h"
 #include "resistor.h"
 #include "pwr.h"
+#include "energy.h"
+#include "can_bulk.h"
 
 #include <string.h>
+#include <stddef.h>
+#include <math.h>
 
 // Settings
-#define RX_FRAMES_SIZE				100
+#define RX_FRAMES_SIZE				128 // Must be a power of two
 #define RX_BUFFER_SIZE				PACKET_MAX_PL_LEN
+#define NODE_SLOT_NONE				0xFF
+#define TX_QUEUE_HIGH_SIZE			16 // Must be a power of two
+#define TX_QUEUE_NORMAL_SIZE		16 // Must be a power of two
+#define TX_QUEUE_BULK_SIZE			32 // Must be a power of two
+#define TX_BULK_WAIT_MS				5
+#define EVT_BULK_ACK				((eventmask_t)1 << 28)
+
+// Private types
+typedef enum {
+	STAT_FRAME_ELEC = 0, // Voltage, current and two temperatures
+	STAT_FRAME_THERM, // All temperatures and the estimated element temperature
+	STAT_FRAME_ENERGY, // Dissipated energy and charge
+	STAT_FRAME_LIMITS, // Derating factors and limit flags
+	STAT_FRAME_DUTY, // Duty cycle and power
+	STAT_FRAME_NUM
+} stat_frame;
+
+typedef struct {
+	uint8_t buf[RX_BUFFER_SIZE];
+	int next; // Offset the next fill frame should have, -1 when free
+	systime_t time; // Last fill frame
+} rx_context;
+
+typedef struct {
+	can_bulk_rx rx;
+	int sender; // -1 when free
+	unsigned short crc;
+	uint8_t commands_send;
+	systime_t time;
+} bulk_rx_context;
+
+typedef struct {
+	uint8_t controller_id;
+	const uint8_t *data;
+	unsigned int len;
+} bulk_tx_buffer;
+
+typedef enum {
+	BULK_RES_OK = 0,
+	BULK_RES_UNSUPPORTED,
+	BULK_RES_FAILED
+} bulk_res;
+
+typedef struct {
+	CANTxFrame frame;
+	uint32_t time; // Realtime counter when queued
+} tx_entry;
+
+typedef struct {
+	tx_entry *buf;
+	uint32_t size;
+	uint32_t read;
+	uint32_t write;
+} tx_queue;
 
 // Private variables
-static can_status_msg stat_msgs[CAN_STATUS_MSGS_TO_STORE];
-static can_status_msg_2 stat_msgs_2[CAN_STATUS_MSGS_TO_STORE];
-static can_status_msg_3 stat_msgs_3[CAN_STATUS_MSGS_TO_STORE];
-static can_status_msg_4 stat_msgs_4[CAN_STATUS_MSGS_TO_STORE];
-static can_status_msg_5 stat_msgs_5[CAN_STATUS_MSGS_TO_STORE];
-static bms_soc_soh_temp_stat bms_stat_msgs[CAN_BMS_STATUS_MSGS_TO_STORE];
+// In SRAM2, which is not cleared at boot. Entries are cleared when they are taken.
+__attribute__((section(".ram4"))) static can_node_status nodes[CAN_NODES_TO_STORE];
+static int nodes_num = 0;
+static uint8_t node_slot[256]; // Index into nodes by controller ID
+static uint32_t node_used[256 / 32]; // Occupancy bitmap by controller ID
 static bms_soc_soh_temp_stat bms_stat_v_cell_min;
-static psw_status psw_stat[CAN_STATUS_MSGS_TO_STORE];
 
 static mutex_t can_mtx;
-static mutex_t can_rx_mtx;
 static CANRxFrame rx_frames[RX_FRAMES_SIZE];
-static int rx_frame_read;
-static int rx_frame_write;
+static volatile uint32_t rx_frame_read = 0;
+static volatile uint32_t rx_frame_write = 0;
+static volatile can_stats stats;
+static tx_entry tx_buf_high[TX_QUEUE_HIGH_SIZE];
+static tx_entry tx_buf_normal[TX_QUEUE_NORMAL_SIZE];
+static tx_entry tx_buf_bulk[TX_QUEUE_BULK_SIZE];
+static tx_queue tx_queues[CAN_TX_PRIO_NUM] = {
+		{tx_buf_high, TX_QUEUE_HIGH_SIZE, 0, 0},
+		{tx_buf_normal, TX_QUEUE_NORMAL_SIZE, 0, 0},
+		{tx_buf_bulk, TX_QUEUE_BULK_SIZE, 0, 0}
+};
+static threads_queue_t tx_bulk_waitq;
 static thread_t *process_tp = 0;
 static thread_t *ping_tp = 0;
+static volatile int ping_id = -1;
 static volatile HW_TYPE ping_hw_last = HW_TYPE_VESC;
-static uint8_t rx_buffer[RX_BUFFER_SIZE];
+static mutex_t scan_mtx;
+static volatile bool scan_active = false;
+static volatile uint32_t scan_seen[256 / 32];
+static rx_context rx_contexts[CAN_RX_CONTEXTS];
 static unsigned int rx_buffer_last_id;
+static bulk_rx_context bulk_rx[CAN_BULK_RX_CONTEXTS];
+static mutex_t bulk_tx_mtx;
+static thread_t *bulk_tx_tp = 0;
+static volatile int bulk_tx_id = -1;
+static uint8_t bulk_ack[CAN_BULK_ACK_LEN];
+static uint32_t bulk_unsupported[256 / 32]; // Nodes that did not answer a bulk start
+static systime_t bulk_unsupported_time[256];
+static systime_t stat_last_sent[STAT_FRAME_NUM];
+static bool stat_ever_sent[STAT_FRAME_NUM];
+static float stat_last_v = 0.0;
+static float stat_last_i = 0.0;
+static float stat_last_temp = 0.0;
+static float stat_last_duty = 0.0;
+static uint8_t stat_last_flags = 0;
+static volatile uint32_t rx_type_counts[CAN_RX_TYPES];
+static volatile uint32_t rx_bits = 0;
+static volatile uint32_t tx_bits = 0;
+static uint32_t err_flags_last = 0;
+static const uint32_t tx_lat_bin_limits[CAN_TX_LAT_BINS] = CAN_TX_LAT_BIN_LIMITS_US;
+static uint32_t status_subscriptions = CAN_STATUS_SUB_ALL;
+static int filter_controller_id = -1;
+static uint32_t filter_subscriptions = 0;
+static bool filter_sid = false;
+
+// Status packets in the same order as the CAN_STATUS_SUB_ bits
+static const CAN_PACKET_ID status_packets[] = {
+		CAN_PACKET_STATUS,
+		CAN_PACKET_STATUS_2,
+		CAN_PACKET_STATUS_3,
+		CAN_PACKET_STATUS_4,
+		CAN_PACKET_STATUS_5,
+		CAN_PACKET_BMS_SOC_SOH_TEMP_STAT,
+		CAN_PACKET_PSW_STAT
+};
 
 // Threads
-static THD_WORKING_AREA(cancom_read_thread_wa, 512);
 static THD_WORKING_AREA(cancom_process_thread_wa, 4096);
 static THD_WORKING_AREA(cancom_status_thread_wa, 512);
-static THD_FUNCTION(cancom_read_thread, arg);
 static THD_FUNCTION(cancom_process_thread, arg);
 static THD_FUNCTION(cancom_status_thread, arg);
 
@@ -67,6 +168,32 @@ static THD_FUNCTION(cancom_status_thread, arg);
 static void set_timing(int brp, int ts1, int ts2);
 static void send_packet_wrapper(unsigned char *data, unsigned int len);
 static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced);
+static void can_rx_full_cb(CANDriver *canp, uint32_t flags);
+static void can_error_cb(CANDriver *canp, uint32_t flags);
+static void can_tx_empty_cb(CANDriver *canp, uint32_t flags);
+static bool tx_enqueue(const CANTxFrame *frame, CAN_TX_PRIO prio);
+static void tx_drain_i(void);
+static int build_filters(CANFilter *filters);
+static can_node_status *node_get(int id);
+static can_node_status *node_get_or_add(uint8_t id);
+static can_node_status *node_with_index(int index, size_t offset);
+static void rx_context_fill(unsigned int offset, const uint8_t *data, int len);
+static rx_context *rx_context_find(unsigned int len, unsigned short crc);
+static void process_rx_buffer(uint8_t *buf, unsigned int len, uint8_t commands_send, bool is_replaced);
+static bool bulk_supported(uint8_t controller_id);
+static bulk_res send_buffer_bulk(uint8_t controller_id, uint8_t *data, unsigned int len, uint8_t send);
+static void bulk_send_data(void *arg, int seq, bool ack_req);
+static bool bulk_wait_ack(uint8_t *ack);
+static void bulk_rx_start(uint8_t *data8, int len);
+static void bulk_rx_data(uint8_t *data8, int len, bool is_replaced);
+static void bulk_rx_send_ack(bulk_rx_context *ctx, int trigger);
+static uint32_t stat_rate(int frame);
+static float stat_temp_max(void);
+static uint8_t stat_limit_flags(void);
+static bool stat_changed(int frame);
+static void stat_send(int frame);
+static uint32_t frame_bits(bool ext, int dlc);
+static void stats_update_rates(void);
 
 /*
  * 500KBaud, automatic wakeup, automatic recover
@@ -84,31 +211,35 @@ static void(*sid_callback)(uint32_t id, uint8_t *data, uint8_t len) = 0;
 
 void comm_can_init(void) {
 	chMtxObjectInit(&can_mtx);
-	chMtxObjectInit(&can_rx_mtx);
-
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		stat_msgs[i].id = -1;
-		stat_msgs_2[i].id = -1;
-		stat_msgs_3[i].id = -1;
-		stat_msgs_4[i].id = -1;
-		stat_msgs_5[i].id = -1;
+	chThdQueueObjectInit(&tx_bulk_waitq);
+	chMtxObjectInit(&scan_mtx);
+	chMtxObjectInit(&bulk_tx_mtx);
 
-		psw_stat[i].id = -1;
-	}
+	nodes_num = 0;
+	memset(node_slot, NODE_SLOT_NONE, sizeof(node_slot));
+	memset(node_used, 0, sizeof(node_used));
 
 	bms_stat_v_cell_min.id = -1;
 
-	for (int i = 0;i < CAN_BMS_STATUS_MSGS_TO_STORE;i++) {
-		bms_stat_msgs[i].id = -1;
+	for (int i = 0;i < CAN_RX_CONTEXTS;i++) {
+		rx_contexts[i].next = -1;
+	}
+
+	for (int i = 0;i < CAN_BULK_RX_CONTEXTS;i++) {
+		bulk_rx[i].sender = -1;
 	}
 
 	palSetLineMode(LINE_CAN_RX, PAL_MODE_ALTERNATE(HW_CAN_AF));
 	palSetLineMode(LINE_CAN_TX, PAL_MODE_ALTERNATE(HW_CAN_AF));
 
+	HW_CAN_DEV.rxfull_cb = can_rx_full_cb;
+	HW_CAN_DEV.error_cb = can_error_cb;
+	HW_CAN_DEV.txempty_cb = can_tx_empty_cb;
+
+	CANFilter filters[STM32_CAN_MAX_FILTERS];
+	canSTM32SetFilters(&HW_CAN_DEV, STM32_CAN_MAX_FILTERS, build_filters(filters), filters);
 	canStart(&HW_CAN_DEV, &cancfg);
 
-	chThdCreateStatic(cancom_read_thread_wa, sizeof(cancom_read_thread_wa), NORMALPRIO + 1,
-			cancom_read_thread, NULL);
 	chThdCreateStatic(cancom_process_thread_wa, sizeof(cancom_process_thread_wa), NORMALPRIO,
 			cancom_process_thread, NULL);
 	chThdCreateStatic(cancom_status_thread_wa, sizeof(cancom_status_thread_wa), NORMALPRIO,
@@ -130,6 +261,30 @@ void comm_can_set_baud(CAN_BAUD baud) {
 }
 
 void comm_can_transmit_eid(uint32_t id, const uint8_t *data, uint8_t len) {
+	comm_can_transmit_eid_prio(id, data, len, CAN_TX_PRIO_NORMAL);
+}
+
+/**
+ * Queue an extended frame for transmission. Frames are sent in priority
+ * order, and in the order they were queued within the same priority.
+ *
+ * @param id
+ * The extended ID.
+ *
+ * @param data
+ * The payload.
+ *
+ * @param len
+ * Payload length, at most 8 bytes.
+ *
+ * @param prio
+ * The priority class. CAN_TX_PRIO_BULK waits up to a few milliseconds for
+ * room in the queue, the other classes never block.
+ *
+ * @return
+ * True if the frame was queued, false if it was dropped.
+ */
+bool comm_can_transmit_eid_prio(uint32_t id, const uint8_t *data, uint8_t len, CAN_TX_PRIO prio) {
 	if (len > 8) {
 		len = 8;
 	}
@@ -141,9 +296,7 @@ void comm_can_transmit_eid(uint32_t id, const uint8_t *data, uint8_t len) {
 	txmsg.DLC = len;
 	memcpy(txmsg.data8, data, len);
 
-	chMtxLock(&can_mtx);
-	canTransmit(&HW_CAN_DEV, CAN_ANY_MAILBOX, &txmsg, TIME_MS2I(5));
-	chMtxUnlock(&can_mtx);
+	return tx_enqueue(&txmsg, prio);
 }
 
 void comm_can_transmit_sid(uint32_t id, const uint8_t *data, uint8_t len) {
@@ -158,18 +311,77 @@ void comm_can_transmit_sid(uint32_t id, const uint8_t *data, uint8_t len) {
 	txmsg.DLC = len;
 	memcpy(txmsg.data8, data, len);
 
-	chMtxLock(&can_mtx);
-	canTransmit(&HW_CAN_DEV, CAN_ANY_MAILBOX, &txmsg, TIME_MS2I(5));
-	chMtxUnlock(&can_mtx);
+	tx_enqueue(&txmsg, CAN_TX_PRIO_NORMAL);
 }
 
 void comm_can_set_sid_rx_callback(void (*p_func)(uint32_t id, uint8_t *data, uint8_t len)) {
 	sid_callback = p_func;
+	comm_can_update_filters();
+}
+
+/**
+ * Select which status messages from other nodes are accepted by the
+ * hardware filters and stored.
+ *
+ * @param mask
+ * Combination of CAN_STATUS_SUB_ bits.
+ */
+void comm_can_set_status_subscriptions(uint32_t mask) {
+	status_subscriptions = mask & CAN_STATUS_SUB_ALL;
+	comm_can_update_filters();
+}
+
+uint32_t comm_can_get_status_subscriptions(void) {
+	return status_subscriptions;
+}
+
+/**
+ * Reprogram the hardware acceptance filters if the controller ID, the
+ * status subscriptions or the SID callback changed since they were last
+ * programmed. The peripheral has to be stopped for that, so frames on the
+ * bus are missed for a moment while this happens.
+ */
+void comm_can_update_filters(void) {
+	if (filter_controller_id == backup.config.controller_id &&
+			filter_subscriptions == status_subscriptions &&
+			filter_sid == (sid_callback != 0)) {
+		return;
+	}
+
+	CANFilter filters[STM32_CAN_MAX_FILTERS];
+	int num = build_filters(filters);
+
+	chMtxLock(&can_mtx);
+	canStop(&HW_CAN_DEV);
+	canSTM32SetFilters(&HW_CAN_DEV, STM32_CAN_MAX_FILTERS, num, filters);
+	canStart(&HW_CAN_DEV, &cancfg);
+
+	// Frames queued while the driver was stopped
+	chSysLock();
+	tx_drain_i();
+	chSchRescheduleS();
+	chSysUnlock();
+	chMtxUnlock(&can_mtx);
 }
 
 void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len, uint8_t send) {
 	uint8_t send_buffer[8];
 
+	// Use the acknowledged transfer with nodes that support it. If it fails
+	// after it has started the receiver may already have processed the buffer,
+	// so it is only sent again the old way if the receiver never answered.
+	// The process thread does not wait for acks, as it has to handle incoming
+	// transfers meanwhile, so replies to CAN commands are sent the old way.
+	// Broadcasts, such as the firmware relay to all nodes, stay one legacy
+	// broadcast, so that they also reach nodes that are not in the status
+	// table or do not support bulk.
+	if (len > 6 && len <= RX_BUFFER_SIZE && controller_id != 255 &&
+			chThdGetSelfX() != process_tp && bulk_supported(controller_id)) {
+		if (send_buffer_bulk(controller_id, data, len, send) != BULK_RES_UNSUPPORTED) {
+			return;
+		}
+	}
+
 	if (len <= 6) {
 		uint32_t ind = 0;
 		send_buffer[ind++] = backup.config.controller_id;
@@ -177,8 +389,11 @@ void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len
 		memcpy(send_buffer + ind, data, len);
 		ind += len;
 
-		comm_can_transmit_eid(controller_id |
-				((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), send_buffer, ind);
+		// Same class as multi-frame buffers, so that buffers to a node are
+		// processed in the order they were sent
+		comm_can_transmit_eid_prio(controller_id |
+				((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), send_buffer, ind,
+				CAN_TX_PRIO_BULK);
 	} else {
 		unsigned int end_a = 0;
 		for (unsigned int i = 0;i < len;i += 7) {
@@ -198,8 +413,9 @@ void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len
 				memcpy(send_buffer + 1, data + i, send_len);
 			}
 
-			comm_can_transmit_eid(controller_id |
-					((uint32_t)CAN_PACKET_FILL_RX_BUFFER << 8), send_buffer, send_len + 1);
+			comm_can_transmit_eid_prio(controller_id |
+					((uint32_t)CAN_PACKET_FILL_RX_BUFFER << 8), send_buffer, send_len + 1,
+					CAN_TX_PRIO_BULK);
 		}
 
 		for (unsigned int i = end_a;i < len;i += 6) {
@@ -214,8 +430,9 @@ void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len
 				memcpy(send_buffer + 2, data + i, send_len);
 			}
 
-			comm_can_transmit_eid(controller_id |
-					((uint32_t)CAN_PACKET_FILL_RX_BUFFER_LONG << 8), send_buffer, send_len + 2);
+			comm_can_transmit_eid_prio(controller_id |
+					((uint32_t)CAN_PACKET_FILL_RX_BUFFER_LONG << 8), send_buffer, send_len + 2,
+					CAN_TX_PRIO_BULK);
 		}
 
 		uint32_t ind = 0;
@@ -227,117 +444,98 @@ void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len
 		send_buffer[ind++] = (uint8_t)(crc >> 8);
 		send_buffer[ind++] = (uint8_t)(crc & 0xFF);
 
-		comm_can_transmit_eid(controller_id |
-				((uint32_t)CAN_PACKET_PROCESS_RX_BUFFER << 8), send_buffer, ind++);
+		// Same class as the fill frames so that it cannot overtake them
+		comm_can_transmit_eid_prio(controller_id |
+				((uint32_t)CAN_PACKET_PROCESS_RX_BUFFER << 8), send_buffer, ind++,
+				CAN_TX_PRIO_BULK);
 	}
 }
 
-can_status_msg *comm_can_get_status_msg_index(int index) {
-	if (index < CAN_STATUS_MSGS_TO_STORE) {
-		return &stat_msgs[index];
-	} else {
-		return 0;
-	}
-}
+/**
+ * Iterate over the nodes that have been seen on the CAN-bus.
+ *
+ * @param id
+ * The previous controller ID, or -1 to get the first one.
+ *
+ * @return
+ * The next controller ID with a status entry, or -1 if there are no more.
+ */
+int comm_can_node_next(int id) {
+	int i = id + 1;
 
-can_status_msg *comm_can_get_status_msg_id(int id) {
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		if (stat_msgs[i].id == id) {
-			return &stat_msgs[i];
+	while (i >= 0 && i < 256) {
+		uint32_t word = node_used[i >> 5] >> (i & 31);
+		if (word) {
+			return i + __builtin_ctz(word);
 		}
+		i = (i | 31) + 1;
 	}
 
-	return 0;
+	return -1;
+}
+
+can_node_status *comm_can_get_node(int id) {
+	return node_get(id);
+}
+
+can_status_msg *comm_can_get_status_msg_index(int index) {
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, status));
+	return node ? &node->status : 0;
+}
+
+can_status_msg *comm_can_get_status_msg_id(int id) {
+	can_node_status *node = node_get(id);
+	return (node && node->status.id >= 0) ? &node->status : 0;
 }
 
 can_status_msg_2 *comm_can_get_status_msg_2_index(int index) {
-	if (index < CAN_STATUS_MSGS_TO_STORE) {
-		return &stat_msgs_2[index];
-	} else {
-		return 0;
-	}
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, status_2));
+	return node ? &node->status_2 : 0;
 }
 
 can_status_msg_2 *comm_can_get_status_msg_2_id(int id) {
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		if (stat_msgs_2[i].id == id) {
-			return &stat_msgs_2[i];
-		}
-	}
-
-	return 0;
+	can_node_status *node = node_get(id);
+	return (node && node->status_2.id >= 0) ? &node->status_2 : 0;
 }
 
 can_status_msg_3 *comm_can_get_status_msg_3_index(int index) {
-	if (index < CAN_STATUS_MSGS_TO_STORE) {
-		return &stat_msgs_3[index];
-	} else {
-		return 0;
-	}
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, status_3));
+	return node ? &node->status_3 : 0;
 }
 
 can_status_msg_3 *comm_can_get_status_msg_3_id(int id) {
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		if (stat_msgs_3[i].id == id) {
-			return &stat_msgs_3[i];
-		}
-	}
-
-	return 0;
+	can_node_status *node = node_get(id);
+	return (node && node->status_3.id >= 0) ? &node->status_3 : 0;
 }
 
 can_status_msg_4 *comm_can_get_status_msg_4_index(int index) {
-	if (index < CAN_STATUS_MSGS_TO_STORE) {
-		return &stat_msgs_4[index];
-	} else {
-		return 0;
-	}
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, status_4));
+	return node ? &node->status_4 : 0;
 }
 
 can_status_msg_4 *comm_can_get_status_msg_4_id(int id) {
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		if (stat_msgs_4[i].id == id) {
-			return &stat_msgs_4[i];
-		}
-	}
-
-	return 0;
+	can_node_status *node = node_get(id);
+	return (node && node->status_4.id >= 0) ? &node->status_4 : 0;
 }
 
 can_status_msg_5 *comm_can_get_status_msg_5_index(int index) {
-	if (index < CAN_STATUS_MSGS_TO_STORE) {
-		return &stat_msgs_5[index];
-	} else {
-		return 0;
-	}
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, status_5));
+	return node ? &node->status_5 : 0;
 }
 
 can_status_msg_5 *comm_can_get_status_msg_5_id(int id) {
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		if (stat_msgs_5[i].id == id) {
-			return &stat_msgs_5[i];
-		}
-	}
-
-	return 0;
+	can_node_status *node = node_get(id);
+	return (node && node->status_5.id >= 0) ? &node->status_5 : 0;
 }
 
 bms_soc_soh_temp_stat *comm_can_get_bms_soc_soh_temp_stat_index(int index) {
-	if (index < CAN_BMS_STATUS_MSGS_TO_STORE) {
-		return &bms_stat_msgs[index];
-	} else {
-		return 0;
-	}
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, bms));
+	return node ? &node->bms : 0;
 }
 
 bms_soc_soh_temp_stat *comm_can_get_bms_soc_soh_temp_stat_id(int id) {
-	for (int i = 0;i < CAN_BMS_STATUS_MSGS_TO_STORE;i++) {
-		if (bms_stat_msgs[i].id == id) {
-			return &bms_stat_msgs[i];
-		}
-	}
-
-	return 0;
+	can_node_status *node = node_get(id);
+	return (node && node->bms.id >= 0) ? &node->bms : 0;
 }
 
 bms_soc_soh_temp_stat *comm_can_get_bms_stat_v_cell_min(void) {
@@ -345,21 +543,23 @@ bms_soc_soh_temp_stat *comm_can_get_bms_stat_v_cell_min(void) {
 }
 
 psw_status *comm_can_get_psw_status_index(int index) {
-	if (index < CAN_STATUS_MSGS_TO_STORE) {
-		return &psw_stat[index];
-	} else {
-		return 0;
-	}
+	can_node_status *node = node_with_index(index, offsetof(can_node_status, psw));
+	return node ? &node->psw : 0;
 }
 
 psw_status *comm_can_get_psw_status_id(int id) {
-	for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-		if (psw_stat[i].id == id) {
-			return &psw_stat[i];
+	can_node_status *node = node_get(id);
+	return (node && node->psw.id >= 0) ? &node->psw : 0;
+}
+
+int comm_can_get_psw_status_num(void) {
+	int num = 0;
+	for (int id = comm_can_node_next(-1);id >= 0;id = comm_can_node_next(id)) {
+		if (nodes[node_slot[id]].psw.id >= 0) {
+			num++;
 		}
 	}
-
-	return 0;
+	return num;
 }
 
 void comm_can_psw_switch(int id, bool is_on, bool plot) {
@@ -386,6 +586,7 @@ void comm_can_psw_switch(int id, bool is_on, bool plot) {
  * True for success, false otherwise.
  */
 bool comm_can_ping(uint8_t controller_id, HW_TYPE *hw_type) {
+	ping_id = controller_id;
 	ping_tp = chThdGetSelfX();
 	chEvtGetAndClearEvents(ALL_EVENTS);
 
@@ -394,8 +595,9 @@ bool comm_can_ping(uint8_t controller_id, HW_TYPE *hw_type) {
 	comm_can_transmit_eid(controller_id |
 			((uint32_t)CAN_PACKET_PING << 8), buffer, 1);
 
-	int ret = chEvtWaitAnyTimeout(1 << 29, TIME_MS2I(10));
+	int ret = chEvtWaitAnyTimeout(1 << 29, TIME_MS2I(CAN_PING_TIMEOUT_MS));
 	ping_tp = 0;
+	ping_id = -1;
 
 	if (ret != 0) {
 		if (hw_type) {
@@ -406,188 +608,710 @@ bool comm_can_ping(uint8_t controller_id, HW_TYPE *hw_type) {
 	return ret != 0;
 }
 
-static THD_FUNCTION(cancom_read_thread, arg) {
-	(void)arg;
-	chRegSetThreadName("CAN read");
+/**
+ * Find all devices on the CAN-bus. A ping is sent to every ID without waiting
+ * for the answers in between, and the pongs are collected for
+ * CAN_PING_TIMEOUT_MS after the last ping has left. The hardware type of each
+ * node that answers is also kept in its node status entry.
+ *
+ * @param ids
+ * Array to store the IDs of the devices that were found in, in ascending
+ * order. Can be 0.
+ *
+ * @param hw_types
+ * Array to store the hardware types of the devices that were found in. Can
+ * be 0.
+ *
+ * @param max
+ * Size of the arrays.
+ *
+ * @return
+ * The number of devices that were found.
+ */
+int comm_can_scan(uint8_t *ids, HW_TYPE *hw_types, int max) {
+	chMtxLock(&scan_mtx);
 
-	event_listener_t el;
-	CANRxFrame rxmsg;
+	for (int i = 0;i < 256 / 32;i++) {
+		scan_seen[i] = 0;
+	}
+	scan_active = true;
 
-	chEvtRegister(&HW_CAN_DEV.rxfull_event, &el, 0);
+	uint8_t buffer[1];
+	buffer[0] = backup.config.controller_id;
+	for (int i = 0;i < 255;i++) {
+		// Bulk waits for room in the queue instead of dropping pings
+		comm_can_transmit_eid_prio(i | ((uint32_t)CAN_PACKET_PING << 8),
+				buffer, 1, CAN_TX_PRIO_BULK);
+	}
 
-	while(!chThdShouldTerminateX()) {
-		timeout_feed_WDT(THREAD_CANBUS);
+	// Wait for the last pings to leave the queue, then for their answers
+	for (int i = 0;i < 500;i++) {
+		if (tx_queues[CAN_TX_PRIO_BULK].read == tx_queues[CAN_TX_PRIO_BULK].write) {
+			break;
+		}
+		chThdSleepMilliseconds(1);
+	}
+	chThdSleepMilliseconds(CAN_PING_TIMEOUT_MS);
 
-		chEvtWaitAnyTimeout(ALL_EVENTS, TIME_MS2I(10));
+	scan_active = false;
 
-		msg_t result = canReceive(&HW_CAN_DEV, CAN_ANY_MAILBOX, &rxmsg, TIME_IMMEDIATE);
+	int num = 0;
+	for (int id = 0;id < 255;id++) {
+		if (!(scan_seen[id >> 5] & (1u << (id & 31)))) {
+			continue;
+		}
 
-		while (result == MSG_OK) {
-			chMtxLock(&can_rx_mtx);
-			rx_frames[rx_frame_write++] = rxmsg;
-			if (rx_frame_write == RX_FRAMES_SIZE) {
-				rx_frame_write = 0;
-			}
-			chMtxUnlock(&can_rx_mtx);
+		if (num < max) {
+			can_node_status *node = node_get(id);
 
-			chEvtSignal(process_tp, (eventmask_t) 1);
+			if (ids) {
+				ids[num] = id;
+			}
 
-			result = canReceive(&HW_CAN_DEV, CAN_ANY_MAILBOX, &rxmsg, TIME_IMMEDIATE);
+			if (hw_types) {
+				hw_types[num] = node ? node->hw_type : HW_TYPE_VESC;
+			}
 		}
+
+		num++;
+	}
+
+	chMtxUnlock(&scan_mtx);
+
+	return num;
+}
+
+void comm_can_get_stats(can_stats *st) {
+	chSysLock();
+	*st = stats;
+	chSysUnlock();
+
+	uint32_t esr = HW_CAN_DEV.can->ESR;
+	st->tec = (esr >> 16) & 0xFF;
+	st->rec = (esr >> 24) & 0xFF;
+}
+
+/**
+ * Get the number of frames received of each packet type.
+ *
+ * @param counts
+ * Array of CAN_RX_TYPES counters, indexed by CAN_PACKET_ID. The last entry
+ * counts standard frames and packet types that do not fit.
+ */
+void comm_can_get_rx_type_counts(uint32_t *counts) {
+	chSysLock();
+	for (int i = 0;i < CAN_RX_TYPES;i++) {
+		counts[i] = rx_type_counts[i];
 	}
+	chSysUnlock();
+}
 
-	chEvtUnregister(&HW_CAN_DEV.rxfull_event, &el);
+void comm_can_reset_stats(void) {
+	chSysLock();
+	memset((void*)&stats, 0, sizeof(stats));
+	memset((void*)rx_type_counts, 0, sizeof(rx_type_counts));
+	chSysUnlock();
 }
 
-static THD_FUNCTION(cancom_process_thread, arg) {
-	(void)arg;
+/*
+ * Approximate length of a frame on the bus in bits, including an average
+ * amount of stuff bits and the interframe space.
+ */
+static uint32_t frame_bits(bool ext, int dlc) {
+	uint32_t bits = (ext ? 67 : 47) + 8 * dlc;
+	return bits + bits / 10;
+}
 
-	chRegSetThreadName("CAN process");
-	process_tp = chThdGetSelfX();
+/*
+ * Update the frame rates and the bus load estimate. Called about once per
+ * second from the status thread.
+ */
+static void stats_update_rates(void) {
+	static systime_t last_time = 0;
+	static uint32_t last_rx = 0;
+	static uint32_t last_tx = 0;
+	static uint32_t last_bits = 0;
+
+	float dt = (float)chVTTimeElapsedSinceX(last_time) / (float)CH_CFG_ST_FREQUENCY;
+	if (dt < 1.0) {
+		return;
+	}
 
-	for(;;) {
-		chEvtWaitAny((eventmask_t) 1);
-
-		for(;;) {
-			chMtxLock(&can_rx_mtx);
-			if (rx_frame_read != rx_frame_write) {
-				CANRxFrame rxmsg = rx_frames[rx_frame_read++];
-				if (rx_frame_read == RX_FRAMES_SIZE) {
-					rx_frame_read = 0;
-				}
-				chMtxUnlock(&can_rx_mtx);
-
-				if (rxmsg.IDE == CAN_IDE_EXT) {
-					decode_msg(rxmsg.EID, rxmsg.data8, rxmsg.DLC, false);
-				} else {
-					if (sid_callback) {
-						sid_callback(rxmsg.SID, rxmsg.data8, rxmsg.DLC);
-					}
-				}
-			} else {
-				chMtxUnlock(&can_rx_mtx);
+	chSysLock();
+	uint32_t rx = stats.rx_frames;
+	uint32_t tx = stats.tx_frames;
+	uint32_t bits = rx_bits + tx_bits;
+	chSysUnlock();
+
+	float bitrate = 0.0;
+	switch (backup.config.can_baud_rate) {
+	case CAN_BAUD_125K: bitrate = 125e3; break;
+	case CAN_BAUD_250K: bitrate = 250e3; break;
+	case CAN_BAUD_500K: bitrate = 500e3; break;
+	case CAN_BAUD_1M: bitrate = 1e6; break;
+	case CAN_BAUD_10K: bitrate = 10e3; break;
+	case CAN_BAUD_20K: bitrate = 20e3; break;
+	case CAN_BAUD_50K: bitrate = 50e3; break;
+	case CAN_BAUD_75K: bitrate = 75e3; break;
+	default: break;
+	}
+
+	stats.rx_rate = (float)(rx - last_rx) / dt;
+	stats.tx_rate = (float)(tx - last_tx) / dt;
+	stats.bus_load = bitrate > 0.0 ? (float)(bits - last_bits) / dt / bitrate : 0.0;
+
+	last_time = chVTGetSystemTimeX();
+	last_rx = rx;
+	last_tx = tx;
+	last_bits = bits;
+}
+
+/*
+ * Called from the CAN RX interrupt. The hardware FIFOs are drained into
+ * rx_frames, which is a single-producer single-consumer queue between this
+ * interrupt and the process thread, and the thread is woken once for all
+ * frames received in the interrupt.
+ */
+static void can_rx_full_cb(CANDriver *canp, uint32_t flags) {
+	(void)flags;
+
+	bool received = false;
+
+	chSysLockFromISR();
+	for (;;) {
+		uint32_t write = rx_frame_write;
+
+		if ((write - rx_frame_read) >= RX_FRAMES_SIZE) {
+			// Queue full. Drop the frame so that the FIFO does not stall.
+			CANRxFrame rxmsg;
+			if (canTryReceiveI(canp, CAN_ANY_MAILBOX, &rxmsg)) {
 				break;
 			}
+			stats.rx_dropped++;
+			continue;
+		}
+
+		CANRxFrame *rxmsg = &rx_frames[write & (RX_FRAMES_SIZE - 1)];
+		if (canTryReceiveI(canp, CAN_ANY_MAILBOX, rxmsg)) {
+			break;
+		}
+
+		stats.rx_frames++;
+		rx_bits += frame_bits(rxmsg->IDE == CAN_IDE_EXT, rxmsg->DLC);
+		if (rxmsg->IDE == CAN_IDE_EXT && (rxmsg->EID >> 8) < (CAN_RX_TYPES - 1)) {
+			rx_type_counts[rxmsg->EID >> 8]++;
+		} else {
+			rx_type_counts[CAN_RX_TYPES - 1]++;
+		}
+
+		// Bulk transfer acks go straight to the sending thread, which can be
+		// the process thread itself.
+		if (rxmsg->IDE == CAN_IDE_EXT &&
+				(rxmsg->EID >> 8) == CAN_PACKET_BULK_ACK &&
+				(rxmsg->EID & 0xFF) == backup.config.controller_id &&
+				rxmsg->DLC >= sizeof(bulk_ack) &&
+				bulk_tx_tp && rxmsg->data8[0] == bulk_tx_id) {
+			memcpy(bulk_ack, rxmsg->data8, sizeof(bulk_ack));
+			chEvtSignalI(bulk_tx_tp, EVT_BULK_ACK);
+			continue;
+		}
+
+		rx_frame_write = write + 1;
+		received = true;
+
+		if ((rx_frame_write - rx_frame_read) > stats.rx_queue_max) {
+			stats.rx_queue_max = rx_frame_write - rx_frame_read;
 		}
 	}
+
+	if (received && process_tp) {
+		chEvtSignalI(process_tp, (eventmask_t) 1);
+	}
+	chSysUnlockFromISR();
 }
 
-static THD_FUNCTION(cancom_status_thread, arg) {
-	(void)arg;
+static void can_error_cb(CANDriver *canp, uint32_t flags) {
+	(void)canp;
 
-	chRegSetThreadName("CAN status");
+	chSysLockFromISR();
 
-	uint8_t buffer[8];
-	memset(buffer, 0, sizeof(buffer));
-	buffer[0] = backup.config.controller_id;
-	comm_can_transmit_eid(backup.config.controller_id | ((uint32_t)CAN_PACKET_BMS_BOOT << 8), buffer, 1);
+	if (flags & CAN_OVERFLOW_ERROR) {
+		stats.rx_overruns++;
+	}
 
-	for(;;) {
-		int32_t send_index = 0;
+	// RX FIFO overflows are reported with CAN_OVERFLOW_ERROR only. Error
+	// interrupts carry a copy of ESR in the upper half word, which is where
+	// the state and last error code are taken from, as the lower bits are
+	// only set with STM32_CAN_REPORT_ALL_ERRORS.
+	if (flags != CAN_OVERFLOW_ERROR) {
+		uint32_t esr = flags >> 16;
 
-		buffer_append_float16(buffer, pwr_get_vin(), 1e2, &send_index);
-		buffer_append_float16(buffer, resistor_get_current_filtered(), 1e2, &send_index);
-		buffer_append_float16(buffer, pwr_get_temp(0), 1e2, &send_index);
-		buffer_append_float16(buffer, pwr_get_temp(1), 1e2, &send_index);
-		comm_can_transmit_eid(backup.config.controller_id | ((uint32_t)CAN_PACKET_IO_BOARD_ADC_1_TO_4 << 8), buffer, send_index);
+		if ((flags & CAN_FRAMING_ERROR) || (esr & CAN_ESR_LEC)) {
+			stats.err_framing++;
+		}
 
-		HW_SEND_CAN_DATA();
+		// The state is reported on every error interrupt, count the
+		// transitions only.
+		uint32_t state = (flags | esr) & (CAN_LIMIT_WARNING | CAN_LIMIT_ERROR | CAN_BUS_OFF_ERROR);
+		uint32_t entered = state & ~err_flags_last;
+		err_flags_last = state;
 
-		while (backup.config.send_can_status_rate_hz == 0) {
-			chThdSleepMilliseconds(10);
+		if (entered & CAN_LIMIT_WARNING) {
+			stats.err_warning++;
 		}
 
-		systime_t sleep_time = CH_CFG_ST_FREQUENCY / backup.config.send_can_status_rate_hz;
-		if (sleep_time == 0) {
-			sleep_time = 1;
+		if (entered & CAN_LIMIT_ERROR) {
+			stats.err_passive++;
 		}
 
-		chThdSleep(sleep_time);
+		if (entered & CAN_BUS_OFF_ERROR) {
+			stats.err_bus_off++;
+		}
 	}
+
+	chSysUnlockFromISR();
 }
 
-static void send_packet_wrapper(unsigned char *data, unsigned int len) {
-	comm_can_send_buffer(rx_buffer_last_id, data, len, 1);
+static void can_tx_empty_cb(CANDriver *canp, uint32_t flags) {
+	(void)canp;
+	(void)flags;
+
+	chSysLockFromISR();
+	tx_drain_i();
+	chSysUnlockFromISR();
 }
 
-static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced) {
-	int32_t ind = 0;
-	unsigned int rxbuf_len;
-	unsigned int rxbuf_ind;
-	uint8_t crc_low;
-	uint8_t crc_high;
-	uint8_t commands_send;
+/*
+ * Add a frame to the TX queue of its priority class and start sending it
+ * right away if a mailbox is free. Only bulk frames wait for room in
+ * their queue, everything else is dropped when the queue is full.
+ */
+static bool tx_enqueue(const CANTxFrame *frame, CAN_TX_PRIO prio) {
+	if (prio >= CAN_TX_PRIO_NUM) {
+		prio = CAN_TX_PRIO_NORMAL;
+	}
 
-	uint8_t id = eid & 0xFF;
-	CAN_PACKET_ID cmd = eid >> 8;
+	tx_queue *q = &tx_queues[prio];
 
-	if (id == 255 || id == backup.config.controller_id) {
-		switch (cmd) {
-		case CAN_PACKET_FILL_RX_BUFFER:
-			memcpy(rx_buffer + data8[0], data8 + 1, len - 1);
-			break;
+	chSysLock();
+	if ((q->write - q->read) >= q->size && prio == CAN_TX_PRIO_BULK) {
+		stats.tx_bulk_stalls++;
+	}
 
-		case CAN_PACKET_FILL_RX_BUFFER_LONG:
-			rxbuf_ind = (unsigned int)data8[0] << 8;
-			rxbuf_ind |= data8[1];
-			if (rxbuf_ind < RX_BUFFER_SIZE) {
-				memcpy(rx_buffer + rxbuf_ind, data8 + 2, len - 2);
-			}
-			break;
+	while ((q->write - q->read) >= q->size) {
+		if (prio != CAN_TX_PRIO_BULK ||
+				chThdEnqueueTimeoutS(&tx_bulk_waitq, TIME_MS2I(TX_BULK_WAIT_MS)) != MSG_OK) {
+			stats.tx_dropped[prio]++;
+			chSysUnlock();
+			return false;
+		}
+	}
 
-		case CAN_PACKET_PROCESS_RX_BUFFER:
-			ind = 0;
-			rx_buffer_last_id = data8[ind++];
-			commands_send = data8[ind++];
-			rxbuf_len = (unsigned int)data8[ind++] << 8;
-			rxbuf_len |= (unsigned int)data8[ind++];
+	tx_entry *e = &q->buf[q->write & (q->size - 1)];
+	e->frame = *frame;
+	e->time = chSysGetRealtimeCounterX();
+	q->write++;
 
-			if (rxbuf_len > RX_BUFFER_SIZE) {
-				break;
-			}
+	if ((q->write - q->read) > stats.tx_queue_max[prio]) {
+		stats.tx_queue_max[prio] = q->write - q->read;
+	}
 
-			crc_high = data8[ind++];
-			crc_low = data8[ind++];
+	tx_drain_i();
+	chSchRescheduleS();
+	chSysUnlock();
 
-			if (crc16(rx_buffer, rxbuf_len)
-					== ((unsigned short) crc_high << 8
-							| (unsigned short) crc_low)) {
-
-				if (is_replaced) {
-					if (rx_buffer[0] == COMM_JUMP_TO_BOOTLOADER ||
-							rx_buffer[0] == COMM_ERASE_NEW_APP ||
-							rx_buffer[0] == COMM_WRITE_NEW_APP_DATA ||
-							rx_buffer[0] == COMM_WRITE_NEW_APP_DATA_LZO ||
-							rx_buffer[0] == COMM_ERASE_BOOTLOADER) {
-						break;
-					}
-				}
+	return true;
+}
 
-				switch (commands_send) {
-				case 0:
-					commands_process_packet(rx_buffer, rxbuf_len, send_packet_wrapper);
-					break;
-				case 1:
-					commands_send_packet(rx_buffer, rxbuf_len);
-					break;
-				case 2:
-					commands_process_packet(rx_buffer, rxbuf_len, 0);
-					break;
-				default:
+/*
+ * Move queued frames to free mailboxes, highest priority class first. Called
+ * with the system locked, from threads and from the TX empty interrupt.
+ */
+static void tx_drain_i(void) {
+	if (HW_CAN_DEV.state != CAN_READY) {
+		return;
+	}
+
+	bool bulk_sent = false;
+
+	for (int prio = 0;prio < CAN_TX_PRIO_NUM;prio++) {
+		tx_queue *q = &tx_queues[prio];
+
+		while (q->read != q->write) {
+			tx_entry *e = &q->buf[q->read & (q->size - 1)];
+
+			if (canTryTransmitI(&HW_CAN_DEV, CAN_ANY_MAILBOX, &e->frame)) {
+				// No free mailbox, continue from the TX empty interrupt
+				goto done;
+			}
+
+			uint32_t latency = (chSysGetRealtimeCounterX() - e->time) / (SystemCoreClock / 1000000);
+			if (latency > stats.tx_latency_max_us[prio]) {
+				stats.tx_latency_max_us[prio] = latency;
+			}
+			stats.tx_latency_avg_us[prio] = (stats.tx_latency_avg_us[prio] * 15 + latency) / 16;
+			stats.tx_frames++;
+			tx_bits += frame_bits(e->frame.IDE == CAN_IDE_EXT, e->frame.DLC);
+
+			for (int i = 0;i < CAN_TX_LAT_BINS;i++) {
+				if (latency < tx_lat_bin_limits[i] || i == (CAN_TX_LAT_BINS - 1)) {
+					stats.tx_latency_hist[i]++;
 					break;
 				}
 			}
-			break;
 
-		case CAN_PACKET_PROCESS_SHORT_BUFFER:
-			ind = 0;
-			rx_buffer_last_id = data8[ind++];
-			commands_send = data8[ind++];
+			q->read++;
 
-			if (is_replaced) {
-				if (data8[ind] == COMM_JUMP_TO_BOOTLOADER ||
-						data8[ind] == COMM_ERASE_NEW_APP ||
-						data8[ind] == COMM_WRITE_NEW_APP_DATA ||
+			if (prio == CAN_TX_PRIO_BULK) {
+				bulk_sent = true;
+			}
+		}
+	}
+
+	done:
+	if (bulk_sent) {
+		chThdDequeueAllI(&tx_bulk_waitq, MSG_OK);
+	}
+}
+
+/*
+ * Fill filters with 32-bit mask mode banks that accept only the frames
+ * decode_msg acts on: everything addressed to our controller ID or to the
+ * broadcast ID 255, the subscribed status messages from any node and, if
+ * someone listens for them, standard frames.
+ *
+ * Returns the number of filters used.
+ */
+static int build_filters(CANFilter *filters) {
+	// Register layout: EID in bits 31:3, IDE in bit 2 and RTR in bit 1
+	const uint32_t ide = 1u << 2;
+	const uint32_t rtr = 1u << 1;
+	const uint32_t mask_id = (0xFFu << 3) | ide | rtr;
+	const uint32_t mask_cmd = (0x1FFFFF00u << 3) | ide | rtr;
+	int num = 0;
+
+	filter_controller_id = backup.config.controller_id;
+	filter_subscriptions = status_subscriptions;
+	filter_sid = sid_callback != 0;
+
+	filters[num].filter = num;
+	filters[num].mode = 0;
+	filters[num].scale = 1;
+	filters[num].assignment = 0;
+	filters[num].register1 = ((uint32_t)filter_controller_id << 3) | ide;
+	filters[num].register2 = mask_id;
+	num++;
+
+	filters[num].filter = num;
+	filters[num].mode = 0;
+	filters[num].scale = 1;
+	filters[num].assignment = 0;
+	filters[num].register1 = (255u << 3) | ide;
+	filters[num].register2 = mask_id;
+	num++;
+
+	for (unsigned int i = 0;i < sizeof(status_packets) / sizeof(status_packets[0]);i++) {
+		if (!(filter_subscriptions & (1 << i))) {
+			continue;
+		}
+
+		filters[num].filter = num;
+		filters[num].mode = 0;
+		filters[num].scale = 1;
+		filters[num].assignment = 0;
+		filters[num].register1 = ((uint32_t)status_packets[i] << 11) | ide;
+		filters[num].register2 = mask_cmd;
+		num++;
+	}
+
+	if (filter_sid) {
+		filters[num].filter = num;
+		filters[num].mode = 0;
+		filters[num].scale = 1;
+		filters[num].assignment = 0;
+		filters[num].register1 = 0;
+		filters[num].register2 = ide | rtr;
+		num++;
+	}
+
+	return num;
+}
+
+static THD_FUNCTION(cancom_process_thread, arg) {
+	(void)arg;
+
+	chRegSetThreadName("CAN process");
+	process_tp = chThdGetSelfX();
+
+	for(;;) {
+		timeout_feed_WDT(THREAD_CANBUS);
+
+		chEvtWaitAnyTimeout((eventmask_t) 1, TIME_MS2I(10));
+
+		while (rx_frame_read != rx_frame_write) {
+			CANRxFrame *rxmsg = &rx_frames[rx_frame_read & (RX_FRAMES_SIZE - 1)];
+
+			if (rxmsg->IDE == CAN_IDE_EXT) {
+				decode_msg(rxmsg->EID, rxmsg->data8, rxmsg->DLC, false);
+			} else {
+				if (sid_callback) {
+					sid_callback(rxmsg->SID, rxmsg->data8, rxmsg->DLC);
+				}
+			}
+
+			// Done with the frame before handing the slot back
+			__DMB();
+			rx_frame_read++;
+		}
+	}
+}
+
+static THD_FUNCTION(cancom_status_thread, arg) {
+	(void)arg;
+
+	chRegSetThreadName("CAN status");
+
+	uint8_t buffer[8];
+	memset(buffer, 0, sizeof(buffer));
+	buffer[0] = backup.config.controller_id;
+	comm_can_transmit_eid(backup.config.controller_id | ((uint32_t)CAN_PACKET_BMS_BOOT << 8), buffer, 1);
+
+	for (int i = 0;i < STAT_FRAME_NUM;i++) {
+		stat_last_sent[i] = chVTGetSystemTimeX();
+		stat_ever_sent[i] = false;
+	}
+
+	for(;;) {
+		systime_t sleep_time = TIME_MS2I(1);
+
+		for (int i = 0;i < STAT_FRAME_NUM;i++) {
+			uint32_t rate = stat_rate(i);
+			systime_t age = chVTTimeElapsedSinceX(stat_last_sent[i]);
+			bool due = false;
+
+			if (rate > 0) {
+				systime_t period = CH_CFG_ST_FREQUENCY / rate;
+				if (period == 0) {
+					period = 1;
+				}
+
+				if (age >= period || !stat_ever_sent[i]) {
+					due = true;
+				} else if ((period - age) < sleep_time) {
+					sleep_time = period - age;
+				}
+			}
+
+			if (!due && stat_changed(i) &&
+					age >= TIME_MS2I(backup.config.can_stat_min_interval_ms)) {
+				due = true;
+			}
+
+			if (due) {
+				stat_send(i);
+				stat_last_sent[i] = chVTGetSystemTimeX();
+				stat_ever_sent[i] = true;
+			}
+		}
+
+		stats_update_rates();
+
+		chThdSleep(sleep_time);
+	}
+}
+
+static uint32_t stat_rate(int frame) {
+	switch (frame) {
+	case STAT_FRAME_ELEC: return backup.config.send_can_status_rate_hz;
+	case STAT_FRAME_THERM: return backup.config.can_stat_therm_rate_hz;
+	case STAT_FRAME_ENERGY: return backup.config.can_stat_energy_rate_hz;
+	case STAT_FRAME_LIMITS: return backup.config.can_stat_limits_rate_hz;
+	case STAT_FRAME_DUTY: return backup.config.can_stat_duty_rate_hz;
+	default: return 0;
+	}
+}
+
+static float stat_temp_max(void) {
+	float temp = resistor_get_temp_est();
+	for (int i = 0;i < HW_ADC_TEMP_SENSORS;i++) {
+		if (pwr_get_temp(i) > temp) {
+			temp = pwr_get_temp(i);
+		}
+	}
+	return temp;
+}
+
+static uint8_t stat_limit_flags(void) {
+	float lo_temp, lo_volts;
+	resistor_get_limits(&lo_temp, &lo_volts);
+
+	uint8_t flags = 0;
+	flags |= (lo_temp < 1.0 ? 1 : 0) << 0;
+	flags |= (lo_volts < 1.0 ? 1 : 0) << 1;
+	flags |= (resistor_get_duty() >= resistor_get_duty_max() &&
+			resistor_get_duty_max() < 1.0 ? 1 : 0) << 2;
+	flags |= (backup.config.tmod_en ? 1 : 0) << 3;
+	return flags;
+}
+
+/*
+ * Check if the values of a status frame have moved outside its deadband
+ * since it was last sent.
+ */
+static bool stat_changed(int frame) {
+	switch (frame) {
+	case STAT_FRAME_ELEC:
+		return (backup.config.can_stat_elec_db_v > 0.0 &&
+				fabsf(pwr_get_vin() - stat_last_v) > backup.config.can_stat_elec_db_v) ||
+				(backup.config.can_stat_elec_db_i > 0.0 &&
+						fabsf(resistor_get_current_filtered() - stat_last_i) > backup.config.can_stat_elec_db_i);
+
+	case STAT_FRAME_THERM:
+		return backup.config.can_stat_therm_db > 0.0 &&
+				fabsf(stat_temp_max() - stat_last_temp) > backup.config.can_stat_therm_db;
+
+	case STAT_FRAME_LIMITS:
+		return stat_limit_flags() != stat_last_flags;
+
+	case STAT_FRAME_DUTY:
+		return backup.config.can_stat_duty_db > 0.0 &&
+				fabsf(resistor_get_duty() - stat_last_duty) > backup.config.can_stat_duty_db;
+
+	default:
+		return false;
+	}
+}
+
+static void stat_send(int frame) {
+	uint8_t buffer[8];
+	int32_t send_index = 0;
+	uint32_t id = backup.config.controller_id;
+
+	switch (frame) {
+	case STAT_FRAME_ELEC:
+		stat_last_v = pwr_get_vin();
+		stat_last_i = resistor_get_current_filtered();
+		buffer_append_float16(buffer, stat_last_v, 1e2, &send_index);
+		buffer_append_float16(buffer, stat_last_i, 1e2, &send_index);
+		buffer_append_float16(buffer, pwr_get_temp(0), 1e2, &send_index);
+		buffer_append_float16(buffer, pwr_get_temp(1), 1e2, &send_index);
+		comm_can_transmit_eid_prio(id | ((uint32_t)CAN_PACKET_IO_BOARD_ADC_1_TO_4 << 8),
+				buffer, send_index, CAN_TX_PRIO_HIGH);
+		HW_SEND_CAN_DATA();
+		break;
+
+	case STAT_FRAME_THERM:
+		stat_last_temp = stat_temp_max();
+		buffer_append_float16(buffer, pwr_get_temp(0), 1e2, &send_index);
+		buffer_append_float16(buffer, pwr_get_temp(1), 1e2, &send_index);
+		buffer_append_float16(buffer, pwr_get_temp(2), 1e2, &send_index);
+		buffer_append_float16(buffer, resistor_get_temp_est(), 1e2, &send_index);
+		comm_can_transmit_eid_prio(id | ((uint32_t)CAN_PACKET_IO_BOARD_ADC_5_TO_8 << 8),
+				buffer, send_index, CAN_TX_PRIO_HIGH);
+		break;
+
+	case STAT_FRAME_ENERGY: {
+		energy_stats energy;
+		energy_get_total(&energy);
+		buffer_append_float32_auto(buffer, energy.wh, &send_index);
+		buffer_append_float32_auto(buffer, energy.ah, &send_index);
+		comm_can_transmit_eid_prio(id | ((uint32_t)CAN_PACKET_RES_ENERGY << 8),
+				buffer, send_index, CAN_TX_PRIO_HIGH);
+	} break;
+
+	case STAT_FRAME_LIMITS: {
+		float lo_temp, lo_volts;
+		resistor_get_limits(&lo_temp, &lo_volts);
+		stat_last_flags = stat_limit_flags();
+		buffer_append_float16(buffer, resistor_get_duty_max(), 1e4, &send_index);
+		buffer_append_float16(buffer, lo_temp, 1e4, &send_index);
+		buffer_append_float16(buffer, lo_volts, 1e4, &send_index);
+		buffer[send_index++] = stat_last_flags;
+		comm_can_transmit_eid_prio(id | ((uint32_t)CAN_PACKET_RES_LIMITS << 8),
+				buffer, send_index, CAN_TX_PRIO_HIGH);
+	} break;
+
+	case STAT_FRAME_DUTY:
+		stat_last_duty = resistor_get_duty();
+		buffer_append_float16(buffer, stat_last_duty, 1e4, &send_index);
+		buffer_append_float32_auto(buffer, pwr_get_vin() * resistor_get_current_filtered(), &send_index);
+		comm_can_transmit_eid_prio(id | ((uint32_t)CAN_PACKET_RES_DUTY << 8),
+				buffer, send_index, CAN_TX_PRIO_HIGH);
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void send_packet_wrapper(unsigned char *data, unsigned int len) {
+	comm_can_send_buffer(rx_buffer_last_id, data, len, 1);
+}
+
+static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced) {
+	int32_t ind = 0;
+	unsigned int rxbuf_len;
+	unsigned int rxbuf_ind;
+	uint8_t crc_low;
+	uint8_t crc_high;
+	uint8_t commands_send;
+
+	uint8_t id = eid & 0xFF;
+	CAN_PACKET_ID cmd = eid >> 8;
+
+	if (id == 255 || id == backup.config.controller_id) {
+		switch (cmd) {
+		case CAN_PACKET_FILL_RX_BUFFER:
+			rx_context_fill(data8[0], data8 + 1, len - 1);
+			break;
+
+		case CAN_PACKET_FILL_RX_BUFFER_LONG:
+			rxbuf_ind = (unsigned int)data8[0] << 8;
+			rxbuf_ind |= data8[1];
+			rx_context_fill(rxbuf_ind, data8 + 2, len - 2);
+			break;
+
+		case CAN_PACKET_PROCESS_RX_BUFFER:
+			ind = 0;
+			rx_buffer_last_id = data8[ind++];
+			commands_send = data8[ind++];
+			rxbuf_len = (unsigned int)data8[ind++] << 8;
+			rxbuf_len |= (unsigned int)data8[ind++];
+
+			if (rxbuf_len > RX_BUFFER_SIZE) {
+				break;
+			}
+
+			crc_high = data8[ind++];
+			crc_low = data8[ind++];
+
+			rx_context *ctx = rx_context_find(rxbuf_len,
+					(unsigned short) crc_high << 8 | (unsigned short) crc_low);
+
+			if (ctx) {
+				// Nothing else writes to the context while the buffer is processed here
+				ctx->next = -1;
+				process_rx_buffer(ctx->buf, rxbuf_len, commands_send, is_replaced);
+			}
+			break;
+
+		case CAN_PACKET_BULK_START:
+			bulk_rx_start(data8, len);
+			break;
+
+		case CAN_PACKET_BULK_DATA:
+			bulk_rx_data(data8, len, is_replaced);
+			break;
+
+		case CAN_PACKET_PROCESS_SHORT_BUFFER:
+			ind = 0;
+			rx_buffer_last_id = data8[ind++];
+			commands_send = data8[ind++];
+
+			if (is_replaced) {
+				if (data8[ind] == COMM_JUMP_TO_BOOTLOADER ||
+						data8[ind] == COMM_ERASE_NEW_APP ||
+						data8[ind] == COMM_WRITE_NEW_APP_DATA ||
 						data8[ind] == COMM_WRITE_NEW_APP_DATA_LZO ||
 						data8[ind] == COMM_ERASE_BOOTLOADER) {
 					break;
@@ -617,17 +1341,25 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 						((uint32_t)CAN_PACKET_PONG << 8), buffer, 2);
 			} break;
 
-			case CAN_PACKET_PONG:
-				// data8[0]; // Sender ID
-				if (ping_tp) {
-					if (len >= 2) {
-						ping_hw_last = data8[1];
-					} else {
-						ping_hw_last = HW_TYPE_VESC_BMS;
-					}
+			case CAN_PACKET_PONG: {
+				uint8_t sender = data8[0];
+				HW_TYPE hw = len >= 2 ? data8[1] : HW_TYPE_VESC_BMS;
+
+				can_node_status *node = node_get_or_add(sender);
+				if (node) {
+					node->hw_type = hw;
+					node->pong_time = node->rx_time;
+				}
+
+				if (scan_active) {
+					scan_seen[sender >> 5] |= 1u << (sender & 31);
+				}
+
+				if (ping_tp && ping_id == sender) {
+					ping_hw_last = hw;
 					chEvtSignal(ping_tp, 1 << 29);
 				}
-				break;
+			} break;
 
 			case CAN_PACKET_SHUTDOWN: {
 				// TODO: Implement when hw has power switch
@@ -651,78 +1383,68 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 	case CAN_PACKET_PING:
 		break;
 
-	case CAN_PACKET_STATUS:
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			can_status_msg *stat_tmp = &stat_msgs[i];
-			if (stat_tmp->id == id || stat_tmp->id == -1) {
-				ind = 0;
-				stat_tmp->id = id;
-				stat_tmp->rx_time = chVTGetSystemTime();
-				stat_tmp->rpm = (float)buffer_get_int32(data8, &ind);
-				stat_tmp->current = (float)buffer_get_int16(data8, &ind) / 10.0;
-				stat_tmp->duty = (float)buffer_get_int16(data8, &ind) / 1000.0;
-				break;
-			}
+	case CAN_PACKET_STATUS: {
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			can_status_msg *stat_tmp = &node->status;
+			ind = 0;
+			stat_tmp->id = id;
+			stat_tmp->rx_time = node->rx_time;
+			stat_tmp->rpm = (float)buffer_get_int32(data8, &ind);
+			stat_tmp->current = (float)buffer_get_int16(data8, &ind) / 10.0;
+			stat_tmp->duty = (float)buffer_get_int16(data8, &ind) / 1000.0;
 		}
-		break;
+	} break;
 
-	case CAN_PACKET_STATUS_2:
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			can_status_msg_2 *stat_tmp_2 = &stat_msgs_2[i];
-			if (stat_tmp_2->id == id || stat_tmp_2->id == -1) {
-				ind = 0;
-				stat_tmp_2->id = id;
-				stat_tmp_2->rx_time = chVTGetSystemTime();
-				stat_tmp_2->amp_hours = (float)buffer_get_int32(data8, &ind) / 1e4;
-				stat_tmp_2->amp_hours_charged = (float)buffer_get_int32(data8, &ind) / 1e4;
-				break;
-			}
+	case CAN_PACKET_STATUS_2: {
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			can_status_msg_2 *stat_tmp_2 = &node->status_2;
+			ind = 0;
+			stat_tmp_2->id = id;
+			stat_tmp_2->rx_time = node->rx_time;
+			stat_tmp_2->amp_hours = (float)buffer_get_int32(data8, &ind) / 1e4;
+			stat_tmp_2->amp_hours_charged = (float)buffer_get_int32(data8, &ind) / 1e4;
 		}
-		break;
+	} break;
 
-	case CAN_PACKET_STATUS_3:
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			can_status_msg_3 *stat_tmp_3 = &stat_msgs_3[i];
-			if (stat_tmp_3->id == id || stat_tmp_3->id == -1) {
-				ind = 0;
-				stat_tmp_3->id = id;
-				stat_tmp_3->rx_time = chVTGetSystemTime();
-				stat_tmp_3->watt_hours = (float)buffer_get_int32(data8, &ind) / 1e4;
-				stat_tmp_3->watt_hours_charged = (float)buffer_get_int32(data8, &ind) / 1e4;
-				break;
-			}
+	case CAN_PACKET_STATUS_3: {
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			can_status_msg_3 *stat_tmp_3 = &node->status_3;
+			ind = 0;
+			stat_tmp_3->id = id;
+			stat_tmp_3->rx_time = node->rx_time;
+			stat_tmp_3->watt_hours = (float)buffer_get_int32(data8, &ind) / 1e4;
+			stat_tmp_3->watt_hours_charged = (float)buffer_get_int32(data8, &ind) / 1e4;
 		}
-		break;
+	} break;
 
-	case CAN_PACKET_STATUS_4:
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			can_status_msg_4 *stat_tmp_4 = &stat_msgs_4[i];
-			if (stat_tmp_4->id == id || stat_tmp_4->id == -1) {
-				ind = 0;
-				stat_tmp_4->id = id;
-				stat_tmp_4->rx_time = chVTGetSystemTime();
-				stat_tmp_4->temp_fet = (float)buffer_get_int16(data8, &ind) / 10.0;
-				stat_tmp_4->temp_motor = (float)buffer_get_int16(data8, &ind) / 10.0;
-				stat_tmp_4->current_in = (float)buffer_get_int16(data8, &ind) / 10.0;
-				stat_tmp_4->pid_pos_now = (float)buffer_get_int16(data8, &ind) / 50.0;
-				break;
-			}
+	case CAN_PACKET_STATUS_4: {
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			can_status_msg_4 *stat_tmp_4 = &node->status_4;
+			ind = 0;
+			stat_tmp_4->id = id;
+			stat_tmp_4->rx_time = node->rx_time;
+			stat_tmp_4->temp_fet = (float)buffer_get_int16(data8, &ind) / 10.0;
+			stat_tmp_4->temp_motor = (float)buffer_get_int16(data8, &ind) / 10.0;
+			stat_tmp_4->current_in = (float)buffer_get_int16(data8, &ind) / 10.0;
+			stat_tmp_4->pid_pos_now = (float)buffer_get_int16(data8, &ind) / 50.0;
 		}
-		break;
+	} break;
 
-	case CAN_PACKET_STATUS_5:
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			can_status_msg_5 *stat_tmp_5 = &stat_msgs_5[i];
-			if (stat_tmp_5->id == id || stat_tmp_5->id == -1) {
-				ind = 0;
-				stat_tmp_5->id = id;
-				stat_tmp_5->rx_time = chVTGetSystemTime();
-				stat_tmp_5->tacho_value = buffer_get_int32(data8, &ind);
-				stat_tmp_5->v_in = (float)buffer_get_int16(data8, &ind) / 1e1;
-				break;
-			}
+	case CAN_PACKET_STATUS_5: {
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			can_status_msg_5 *stat_tmp_5 = &node->status_5;
+			ind = 0;
+			stat_tmp_5->id = id;
+			stat_tmp_5->rx_time = node->rx_time;
+			stat_tmp_5->tacho_value = buffer_get_int32(data8, &ind);
+			stat_tmp_5->v_in = (float)buffer_get_int16(data8, &ind) / 1e1;
 		}
-		break;
+	} break;
 
 	case CAN_PACKET_BMS_SOC_SOH_TEMP_STAT: {
 		int32_t ind = 0;
@@ -748,46 +1470,461 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 			bms_stat_v_cell_min = msg;
 		}
 
-		for (int i = 0;i < CAN_BMS_STATUS_MSGS_TO_STORE;i++) {
-			bms_soc_soh_temp_stat *msg_buf = &bms_stat_msgs[i];
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			node->bms = msg;
+		}
+	} break;
+
+	case CAN_PACKET_PSW_STAT: {
+		can_node_status *node = node_get_or_add(id);
+		if (node) {
+			psw_status *msg = &node->psw;
+			ind = 0;
+			msg->id = id;
+			msg->rx_time = node->rx_time;
+
+			msg->v_in = buffer_get_float16(data8, 10.0, &ind);
+			msg->v_out = buffer_get_float16(data8, 10.0, &ind);
+			msg->temp = buffer_get_float16(data8, 10.0, &ind);
+			msg->is_out_on = (data8[ind] >> 0) & 1;
+			msg->is_pch_on = (data8[ind] >> 1) & 1;
+			msg->is_dsc_on = (data8[ind] >> 2) & 1;
+			ind++;
+		}
+	} break;
+
+	default:
+		break;
+	}
+}
+
+static can_node_status *node_get(int id) {
+	if (id < 0 || id > 255 || node_slot[id] == NODE_SLOT_NONE) {
+		return 0;
+	}
+
+	return &nodes[node_slot[id]];
+}
 
-			// Reset ID after 10 minutes of silence
-			if (msg_buf->id != -1 && UTILS_AGE_S(msg_buf->rx_time) > 60 * 10) {
-				msg_buf->id = -1;
+/*
+ * Get the status entry of a node and update its receive time, adding the
+ * node if it is new. When the table is full the entry of the node that has
+ * been silent the longest is taken over, provided that it has been silent
+ * for more than CAN_NODE_TIMEOUT_S. Returns 0 if there is no room.
+ */
+static can_node_status *node_get_or_add(uint8_t id) {
+	can_node_status *node = node_get(id);
+
+	if (!node) {
+		int slot = -1;
+
+		if (nodes_num < (int)CAN_NODES_TO_STORE) {
+			slot = nodes_num++;
+		} else {
+			systime_t age_max = 0;
+			for (int i = 0;i < (int)CAN_NODES_TO_STORE;i++) {
+				systime_t age = chVTTimeElapsedSinceX(nodes[i].rx_time);
+				if (age >= age_max) {
+					age_max = age;
+					slot = i;
+				}
 			}
 
-			if (msg_buf->id == id || msg_buf->id == -1) {
-				*msg_buf = msg;
-				break;
+			if (age_max < TIME_S2I(CAN_NODE_TIMEOUT_S)) {
+				return 0;
 			}
+
+			int id_old = nodes[slot].id;
+			node_slot[id_old] = NODE_SLOT_NONE;
+			node_used[id_old >> 5] &= ~(1u << (id_old & 31));
 		}
-	} break;
 
-	case CAN_PACKET_PSW_STAT: {
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			psw_status *msg = &psw_stat[i];
-			if (msg->id == id || msg->id == -1) {
-				ind = 0;
-				msg->id = id;
-				msg->rx_time = chVTGetSystemTime();
-
-				msg->v_in = buffer_get_float16(data8, 10.0, &ind);
-				msg->v_out = buffer_get_float16(data8, 10.0, &ind);
-				msg->temp = buffer_get_float16(data8, 10.0, &ind);
-				msg->is_out_on = (data8[ind] >> 0) & 1;
-				msg->is_pch_on = (data8[ind] >> 1) & 1;
-				msg->is_dsc_on = (data8[ind] >> 2) & 1;
-				ind++;
-				break;
+		node = &nodes[slot];
+		memset(node, 0, sizeof(can_node_status));
+		node->id = id;
+		node->hw_type = -1;
+		node->status.id = -1;
+		node->status_2.id = -1;
+		node->status_3.id = -1;
+		node->status_4.id = -1;
+		node->status_5.id = -1;
+		node->bms.id = -1;
+		node->psw.id = -1;
+
+		node_slot[id] = slot;
+		node_used[id >> 5] |= 1u << (id & 31);
+	}
+
+	node->rx_time = chVTGetSystemTime();
+	return node;
+}
+
+/*
+ * Get the node at position index among the nodes, in controller ID order,
+ * that have received the status message at offset in can_node_status.
+ */
+static can_node_status *node_with_index(int index, size_t offset) {
+	for (int id = comm_can_node_next(-1);id >= 0;id = comm_can_node_next(id)) {
+		can_node_status *node = &nodes[node_slot[id]];
+
+		// All status messages start with their id
+		if (*(int*)((uint8_t*)node + offset) >= 0) {
+			if (index == 0) {
+				return node;
 			}
+			index--;
 		}
-	} break;
+	}
+
+	return 0;
+}
+
+static void process_rx_buffer(uint8_t *buf, unsigned int len, uint8_t commands_send, bool is_replaced) {
+	if (is_replaced) {
+		if (buf[0] == COMM_JUMP_TO_BOOTLOADER ||
+				buf[0] == COMM_ERASE_NEW_APP ||
+				buf[0] == COMM_WRITE_NEW_APP_DATA ||
+				buf[0] == COMM_WRITE_NEW_APP_DATA_LZO ||
+				buf[0] == COMM_ERASE_BOOTLOADER) {
+			return;
+		}
+	}
 
+	switch (commands_send) {
+	case 0:
+		commands_process_packet(buf, len, send_packet_wrapper);
+		break;
+	case 1:
+		commands_send_packet(buf, len);
+		break;
+	case 2:
+		commands_process_packet(buf, len, 0);
+		break;
 	default:
 		break;
 	}
 }
 
+/*
+ * Acknowledged bulk transfer, see can_bulk.c for the protocol. Returns
+ * BULK_RES_UNSUPPORTED if the receiver did not answer the start frame.
+ */
+static bulk_res send_buffer_bulk(uint8_t controller_id, uint8_t *data, unsigned int len, uint8_t send) {
+	uint8_t buffer[8];
+	uint8_t ack[sizeof(bulk_ack)];
+	bulk_res res = BULK_RES_FAILED;
+
+	chMtxLock(&bulk_tx_mtx);
+
+	chEvtGetAndClearEvents(EVT_BULK_ACK);
+	bulk_tx_id = controller_id;
+	bulk_tx_tp = chThdGetSelfX();
+
+	int32_t ind = 0;
+	unsigned short crc = crc16(data, len);
+	buffer[ind++] = backup.config.controller_id;
+	buffer[ind++] = send;
+	buffer[ind++] = len >> 8;
+	buffer[ind++] = len & 0xFF;
+	buffer[ind++] = crc >> 8;
+	buffer[ind++] = crc & 0xFF;
+
+	bool started = false;
+	for (int i = 0;i <= CAN_BULK_RETRIES;i++) {
+		comm_can_transmit_eid_prio(controller_id | ((uint32_t)CAN_PACKET_BULK_START << 8),
+				buffer, ind, CAN_TX_PRIO_BULK);
+
+		if (bulk_wait_ack(ack) && ack[1] == CAN_BULK_STATUS_RUNNING && ack[2] == 0) {
+			started = true;
+			break;
+		}
+	}
+
+	if (!started) {
+		// Lost acks look the same as a node without bulk support, so the
+		// node is only skipped for a while
+		bulk_unsupported_time[controller_id] = chVTGetSystemTimeX();
+		bulk_unsupported[controller_id >> 5] |= 1u << (controller_id & 31);
+		res = BULK_RES_UNSUPPORTED;
+		goto done;
+	}
+
+	bulk_unsupported[controller_id >> 5] &= ~(1u << (controller_id & 31));
+
+	bulk_tx_buffer buf = {controller_id, data, len};
+	can_bulk_tx tx;
+	can_bulk_tx_init(&tx, len, bulk_send_data, &buf);
+
+	for (;;) {
+		can_bulk_tx_send_window(&tx);
+
+		CAN_BULK_TX_RES tx_res = bulk_wait_ack(ack) ?
+				can_bulk_tx_ack(&tx, ack) : can_bulk_tx_timeout(&tx);
+
+		if (tx_res != CAN_BULK_TX_RUNNING) {
+			res = tx_res == CAN_BULK_TX_DONE ? BULK_RES_OK : BULK_RES_FAILED;
+			break;
+		}
+	}
+
+	done:
+	bulk_tx_tp = 0;
+	bulk_tx_id = -1;
+	chMtxUnlock(&bulk_tx_mtx);
+
+	return res;
+}
+
+/*
+ * Buffers for nodes that did not answer a bulk start are sent the old way for
+ * CAN_BULK_UNSUPPORTED_S, after which bulk is tried with them again.
+ */
+static bool bulk_supported(uint8_t controller_id) {
+	if (!(bulk_unsupported[controller_id >> 5] & (1u << (controller_id & 31)))) {
+		return true;
+	}
+
+	return chVTTimeElapsedSinceX(bulk_unsupported_time[controller_id]) >
+			TIME_S2I(CAN_BULK_UNSUPPORTED_S);
+}
+
+static void bulk_send_data(void *arg, int seq, bool ack_req) {
+	bulk_tx_buffer *buf = (bulk_tx_buffer*)arg;
+	uint8_t buffer[8];
+	unsigned int offset = seq * 6;
+	unsigned int send_len = (buf->len - offset) < 6 ? (buf->len - offset) : 6;
+
+	buffer[0] = backup.config.controller_id;
+	buffer[1] = seq | (ack_req ? CAN_BULK_SEQ_ACK_REQ : 0);
+	memcpy(buffer + 2, buf->data + offset, send_len);
+
+	comm_can_transmit_eid_prio(buf->controller_id | ((uint32_t)CAN_PACKET_BULK_DATA << 8),
+			buffer, send_len + 2, CAN_TX_PRIO_BULK);
+}
+
+static bool bulk_wait_ack(uint8_t *ack) {
+	if (chEvtWaitAnyTimeout(EVT_BULK_ACK, TIME_MS2I(CAN_BULK_ACK_TIMEOUT_MS)) == 0) {
+		return false;
+	}
+
+	chSysLock();
+	memcpy(ack, bulk_ack, sizeof(bulk_ack));
+	chSysUnlock();
+
+	return true;
+}
+
+static void bulk_rx_start(uint8_t *data8, int len) {
+	if (len < 6) {
+		return;
+	}
+
+	int32_t ind = 0;
+	int sender = data8[ind++];
+	uint8_t commands_send = data8[ind++];
+	unsigned int buf_len = (unsigned int)data8[ind++] << 8;
+	buf_len |= data8[ind++];
+	unsigned short crc = (unsigned short)data8[ind++] << 8;
+	crc |= data8[ind++];
+
+	if (buf_len == 0 || buf_len > CAN_BULK_BUFFER_SIZE) {
+		return;
+	}
+
+	// Restart the context of this sender, or take a free one or the oldest
+	bulk_rx_context *ctx = 0;
+	systime_t age_max = 0;
+	for (int i = 0;i < CAN_BULK_RX_CONTEXTS;i++) {
+		bulk_rx_context *c = &bulk_rx[i];
+
+		if (c->sender == sender) {
+			ctx = c;
+			break;
+		}
+
+		systime_t age = c->sender < 0 ? (systime_t)-1 : chVTTimeElapsedSinceX(c->time);
+		if (!ctx || age > age_max) {
+			age_max = age;
+			ctx = c;
+		}
+	}
+
+	ctx->sender = sender;
+	ctx->crc = crc;
+	ctx->commands_send = commands_send;
+	ctx->time = chVTGetSystemTime();
+	can_bulk_rx_init(&ctx->rx, buf_len);
+
+	bulk_rx_send_ack(ctx, 0);
+}
+
+static void bulk_rx_data(uint8_t *data8, int len, bool is_replaced) {
+	if (len < 3) {
+		return;
+	}
+
+	int sender = data8[0];
+	int seq = data8[1] & ~CAN_BULK_SEQ_ACK_REQ;
+	bool ack_req = data8[1] & CAN_BULK_SEQ_ACK_REQ;
+
+	bulk_rx_context *ctx = 0;
+	for (int i = 0;i < CAN_BULK_RX_CONTEXTS;i++) {
+		if (bulk_rx[i].sender == sender) {
+			ctx = &bulk_rx[i];
+			break;
+		}
+	}
+
+	if (!ctx) {
+		return;
+	}
+
+	switch (can_bulk_rx_data(&ctx->rx, seq, data8 + 2, len - 2)) {
+	case CAN_BULK_RX_COMPLETE:
+		ctx->time = chVTGetSystemTime();
+		ctx->rx.status = crc16(ctx->rx.buf, ctx->rx.len) == ctx->crc ?
+				CAN_BULK_STATUS_DONE : CAN_BULK_STATUS_ERROR;
+
+		// Ack before processing, so that the reply does not race the ack
+		bulk_rx_send_ack(ctx, seq);
+
+		if (ctx->rx.status == CAN_BULK_STATUS_DONE) {
+			rx_buffer_last_id = sender;
+			process_rx_buffer(ctx->rx.buf, ctx->rx.len, ctx->commands_send, is_replaced);
+		}
+		break;
+
+	case CAN_BULK_RX_STORED:
+	case CAN_BULK_RX_FINISHED:
+		ctx->time = chVTGetSystemTime();
+		if (ack_req) {
+			bulk_rx_send_ack(ctx, seq);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void bulk_rx_send_ack(bulk_rx_context *ctx, int trigger) {
+	uint8_t buffer[CAN_BULK_ACK_LEN];
+	int32_t ind = 0;
+	buffer[ind++] = backup.config.controller_id;
+	can_bulk_rx_ack(&ctx->rx, trigger, buffer, &ind);
+
+	comm_can_transmit_eid_prio(ctx->sender | ((uint32_t)CAN_PACKET_BULK_ACK << 8),
+			buffer, ind, CAN_TX_PRIO_HIGH);
+}
+
+/*
+ * The fill frames do not carry the ID of their sender, so the buffers that
+ * are received at the same time are told apart by their offsets. A frame with
+ * offset 0 starts a new buffer. The other frames continue the buffer that
+ * expects their offset, and if several buffers do, the one that was written
+ * most recently, as senders tend to send their frames in bursts. A context
+ * that has been idle for CAN_RX_CONTEXT_TIMEOUT_MS is free, and if none are
+ * free the least recently used one is taken.
+ *
+ * NOTE: Senders that send buffers in lockstep, with their frames interleaved
+ * at the same offsets, are not supported. Their frames can end up in each
+ * other's context, and both buffers are then dropped by the CRC check in
+ * rx_context_find. The frame format is the one all VESC devices use, so the
+ * sender cannot be added to it. Use the bulk transfer, which does carry the
+ * sender, when several nodes send long buffers at the same time.
+ */
+static void rx_context_fill(unsigned int offset, const uint8_t *data, int len) {
+	if (len <= 0 || (offset + len) > RX_BUFFER_SIZE) {
+		return;
+	}
+
+	rx_context *ctx = 0;
+
+	if (offset == 0) {
+		systime_t age_max = 0;
+		for (int i = 0;i < CAN_RX_CONTEXTS;i++) {
+			rx_context *c = &rx_contexts[i];
+			systime_t age = chVTTimeElapsedSinceX(c->time);
+
+			if (c->next < 0 || age > TIME_MS2I(CAN_RX_CONTEXT_TIMEOUT_MS)) {
+				ctx = c;
+				break;
+			}
+
+			if (!ctx || age > age_max) {
+				age_max = age;
+				ctx = c;
+			}
+		}
+	} else {
+		systime_t age_min = 0;
+		for (int i = 0;i < CAN_RX_CONTEXTS;i++) {
+			rx_context *c = &rx_contexts[i];
+			systime_t age = chVTTimeElapsedSinceX(c->time);
+
+			if (c->next != (int)offset || age > TIME_MS2I(CAN_RX_CONTEXT_TIMEOUT_MS)) {
+				continue;
+			}
+
+			if (!ctx || age < age_min) {
+				age_min = age;
+				ctx = c;
+			}
+		}
+	}
+
+	if (!ctx) {
+		return;
+	}
+
+	memcpy(ctx->buf + offset, data, len);
+	ctx->next = offset + len;
+	ctx->time = chVTGetSystemTime();
+}
+
+/*
+ * Find the context holding a complete buffer of length len with the given
+ * CRC, trying the most recently written contexts first.
+ */
+static rx_context *rx_context_find(unsigned int len, unsigned short crc) {
+	bool tried[CAN_RX_CONTEXTS] = {false};
+
+	for (int n = 0;n < CAN_RX_CONTEXTS;n++) {
+		rx_context *ctx = 0;
+		int ctx_ind = -1;
+		systime_t age_min = 0;
+
+		for (int i = 0;i < CAN_RX_CONTEXTS;i++) {
+			rx_context *c = &rx_contexts[i];
+			systime_t age = chVTTimeElapsedSinceX(c->time);
+
+			if (tried[i] || c->next < (int)len ||
+					age > TIME_MS2I(CAN_RX_CONTEXT_TIMEOUT_MS)) {
+				continue;
+			}
+
+			if (!ctx || age < age_min) {
+				age_min = age;
+				ctx = c;
+				ctx_ind = i;
+			}
+		}
+
+		if (!ctx) {
+			break;
+		}
+
+		if (crc16(ctx->buf, len) == crc) {
+			return ctx;
+		}
+
+		tried[ctx_ind] = true;
+	}
+
+	return 0;
+}
+
 /**
  * Set the CAN timing. The CAN is clocked at 80 MHz, and the baud rate can be
  * calculated with
@@ -814,6 +1951,13 @@ static void set_timing(int brp, int ts1, int ts2) {
 	cancfg.btr = CAN_BTR_SJW(3) | CAN_BTR_TS2(ts2) |
 		CAN_BTR_TS1(ts1) | CAN_BTR_BRP(brp);
 
+	chMtxLock(&can_mtx);
 	canStop(&HW_CAN_DEV);
 	canStart(&HW_CAN_DEV, &cancfg);
+
+	chSysLock();
+	tx_drain_i();
+	chSchRescheduleS();
+	chSysUnlock();
+	chMtxUnlock(&can_mtx);
 }
@@ -23,17 +23,43 @@
 #include "conf_general.h"
 
 // Settings
-#define CAN_STATUS_MSGS_TO_STORE		10
-#define CAN_BMS_STATUS_MSGS_TO_STORE	185
+#ifndef CAN_STATUS_MEM_BUDGET
+#define CAN_STATUS_MEM_BUDGET			(30 * 1024) // Bytes of SRAM2 used for status from other nodes
+#endif
+#define CAN_NODES_TO_STORE				((CAN_STATUS_MEM_BUDGET / sizeof(can_node_status)) < 254 ? \
+										(CAN_STATUS_MEM_BUDGET / sizeof(can_node_status)) : 254)
+#define CAN_NODE_TIMEOUT_S				(60 * 10) // Silent nodes can be replaced after this time
+#define CAN_PING_TIMEOUT_MS				10
+#define CAN_RX_CONTEXTS					4 // Buffers that can be received at the same time
+#define CAN_RX_CONTEXT_TIMEOUT_MS		500
+#define CAN_BULK_ACK_TIMEOUT_MS			10
+#define CAN_BULK_UNSUPPORTED_S			10 // Time before bulk is tried again with a node that did not answer
+#define CAN_BULK_RX_CONTEXTS			2
+
+// Status messages from other nodes to accept and store
+#define CAN_STATUS_SUB_STATUS			(1 << 0)
+#define CAN_STATUS_SUB_STATUS_2			(1 << 1)
+#define CAN_STATUS_SUB_STATUS_3			(1 << 2)
+#define CAN_STATUS_SUB_STATUS_4			(1 << 3)
+#define CAN_STATUS_SUB_STATUS_5			(1 << 4)
+#define CAN_STATUS_SUB_BMS				(1 << 5)
+#define CAN_STATUS_SUB_PSW				(1 << 6)
+#define CAN_STATUS_SUB_ALL				0x7F
 
 // Functions
 void comm_can_init(void);
 void comm_can_set_baud(CAN_BAUD baud);
 void comm_can_transmit_eid(uint32_t id, const uint8_t *data, uint8_t len);
+bool comm_can_transmit_eid_prio(uint32_t id, const uint8_t *data, uint8_t len, CAN_TX_PRIO prio);
 void comm_can_transmit_sid(uint32_t id, const uint8_t *data, uint8_t len);
 void comm_can_set_sid_rx_callback(void (*p_func)(uint32_t id, uint8_t *data, uint8_t len));
 void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len, uint8_t send);
+void comm_can_set_status_subscriptions(uint32_t mask);
+uint32_t comm_can_get_status_subscriptions(void);
+void comm_can_update_filters(void);
 
+int comm_can_node_next(int id);
+can_node_status *comm_can_get_node(int id);
 can_status_msg *comm_can_get_status_msg_index(int index);
 can_status_msg *comm_can_get_status_msg_id(int id);
 can_status_msg_2 *comm_can_get_status_msg_2_index(int index);
@@ -49,8 +75,13 @@ bms_soc_soh_temp_stat *comm_can_get_bms_soc_soh_temp_stat_id(int id);
 bms_soc_soh_temp_stat *comm_can_get_bms_stat_v_cell_min(void);
 psw_status *comm_can_get_psw_status_index(int index);
 psw_status *comm_can_get_psw_status_id(int id);
+int comm_can_get_psw_status_num(void);
 void comm_can_psw_switch(int id, bool is_on, bool plot);
 
 bool comm_can_ping(uint8_t controller_id, HW_TYPE *hw_type);
+int comm_can_scan(uint8_t *ids, HW_TYPE *hw_types, int max);
+void comm_can_get_stats(can_stats *stats);
+void comm_can_get_rx_type_counts(uint32_t *counts);
+void comm_can_reset_stats(void);
 
 #endif /* COMM_CAN_H_ */
@@ -65,6 +65,12 @@ void comm_uart_send_packet(unsigned char *data, unsigned int len) {
 	chMtxUnlock(&send_mutex);
 }
 
+void comm_uart_send_packet_seg(const packet_seg_t *segs, int seg_num) {
+	chMtxLock(&send_mutex);
+	packet_send_packet_seg(segs, seg_num, &packet_state);
+	chMtxUnlock(&send_mutex);
+}
+
 static void write_packet(unsigned char *data, unsigned int len) {
 	sdWrite(&HW_UART_DEV, data, len);
 }
@@ -84,14 +90,14 @@ static THD_FUNCTION(packet_process_thread, arg) {
 	for(;;) {
 		chEvtWaitAnyTimeout(ALL_EVENTS, TIME_MS2I(10));
 
-		bool rx = true;
-		while (rx) {
-			rx = false;
-			msg_t res = sdGetTimeout(&HW_UART_DEV, TIME_IMMEDIATE);
-			if (res != MSG_TIMEOUT) {
-				packet_process_byte(res, &packet_state);
-				rx = true;
+		for (;;) {
+			uint8_t buffer[64];
+			size_t len = sdReadTimeout(&HW_UART_DEV, buffer, sizeof(buffer), TIME_IMMEDIATE);
+			if (len == 0) {
+				break;
 			}
+
+			packet_process_buffer(buffer, len, &packet_state);
 		}
 	}
 }
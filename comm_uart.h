@@ -20,7 +20,10 @@
 #ifndef COMM_UART_H_
 #define COMM_UART_H_
 
+#include "packet.h"
+
 void comm_uart_init(void);
 void comm_uart_send_packet(unsigned char *data, unsigned int len);
+void comm_uart_send_packet_seg(const packet_seg_t *segs, int seg_num);
 
 #endif /* COMM_UART_H_ */
@@ -24,6 +24,8 @@
 #include "usbcfg.h"
 #include "commands.h"
 
+#include <string.h>
+
 #if HAL_USE_USB
 
 // Private variables
@@ -50,7 +52,6 @@ static THD_FUNCTION(serial_read_thread, arg) {
 	chRegSetThreadName("USB read");
 
 	uint8_t buffer[102];
-	int had_data = 0;
 
 	for(;;) {
 		// http://forum.chibios.org/viewtopic.php?f=25&t=3938&start=10
@@ -58,21 +59,24 @@ static THD_FUNCTION(serial_read_thread, arg) {
 		int len = chnReadTimeout(&SDU1, (uint8_t*) buffer, 100, 1);
 		chThdSleep(1);
 
-		for (int i = 0;i < len;i++) {
+		if (len > 0) {
+			// Copy the chunk in at most two parts, split where the ring wraps
 			chMtxLock(&rx_mtx);
-			serial_rx_buffer[serial_rx_write_pos++] = buffer[i];
+			int first = SERIAL_RX_BUFFER_SIZE - serial_rx_write_pos;
+			if (first > len) {
+				first = len;
+			}
 
-			if (serial_rx_write_pos == SERIAL_RX_BUFFER_SIZE) {
-				serial_rx_write_pos = 0;
+			memcpy(serial_rx_buffer + serial_rx_write_pos, buffer, first);
+			memcpy(serial_rx_buffer, buffer + first, len - first);
+
+			serial_rx_write_pos += len;
+			if (serial_rx_write_pos >= SERIAL_RX_BUFFER_SIZE) {
+				serial_rx_write_pos -= SERIAL_RX_BUFFER_SIZE;
 			}
 			chMtxUnlock(&rx_mtx);
 
-			had_data = 1;
-		}
-
-		if (had_data) {
 			chEvtSignal(process_tp, (eventmask_t) 1);
-			had_data = 0;
 		}
 	}
 }
@@ -87,21 +91,25 @@ static THD_FUNCTION(serial_process_thread, arg) {
 	for(;;) {
 		chEvtWaitAny((eventmask_t) 1);
 
+		// Process the received data in contiguous spans. Only this thread
+		// moves the read position, so the span can be processed without
+		// holding the lock.
 		for (;;) {
 			chMtxLock(&rx_mtx);
-			if (serial_rx_read_pos != serial_rx_write_pos) {
-				uint8_t byte = serial_rx_buffer[serial_rx_read_pos++];
-
-				if (serial_rx_read_pos == SERIAL_RX_BUFFER_SIZE) {
-					serial_rx_read_pos = 0;
-				}
-				chMtxUnlock(&rx_mtx);
+			int write_pos = serial_rx_write_pos;
+			chMtxUnlock(&rx_mtx);
 
-				packet_process_byte(byte, &packet_state);
-			} else {
-				chMtxUnlock(&rx_mtx);
+			if (serial_rx_read_pos == write_pos) {
 				break;
 			}
+
+			int end = write_pos > serial_rx_read_pos ? write_pos : SERIAL_RX_BUFFER_SIZE;
+			packet_process_buffer(serial_rx_buffer + serial_rx_read_pos,
+					end - serial_rx_read_pos, &packet_state);
+
+			chMtxLock(&rx_mtx);
+			serial_rx_read_pos = end == SERIAL_RX_BUFFER_SIZE ? 0 : end;
+			chMtxUnlock(&rx_mtx);
 		}
 	}
 }
@@ -149,6 +157,12 @@ void comm_usb_send_packet(unsigned char *data, unsigned int len) {
 	chMtxUnlock(&send_mutex);
 }
 
+void comm_usb_send_packet_seg(const packet_seg_t *segs, int seg_num) {
+	chMtxLock(&send_mutex);
+	packet_send_packet_seg(segs, seg_num, &packet_state);
+	chMtxUnlock(&send_mutex);
+}
+
 unsigned int comm_usb_get_write_timeout_cnt(void) {
 	return write_timeout_cnt;
 }
@@ -21,10 +21,12 @@
 #define COMM_USB_H_
 
 #include "conf_general.h"
+#include "packet.h"
 
 // Functions
 void comm_usb_init(void);
 void comm_usb_send_packet(unsigned char *data, unsigned int len);
+void comm_usb_send_packet_seg(const packet_seg_t *segs, int seg_num);
 unsigned int comm_usb_get_write_timeout_cnt(void);
 
 #endif /* COMM_USB_H_ */
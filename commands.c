@@ -29,6 +29,12 @@
 #include "flash_helper.h"
 #include "timeout.h"
 #include "utils.h"
+#include "energy.h"
+#include "telemetry.h"
+#include "capture.h"
+#include "comm_usb.h"
+#include "comm_uart.h"
+#include "lzo.h"
 
 #include <math.h>
 #include <string.h>
@@ -38,6 +44,8 @@
 // Private variables
 static uint8_t send_buffer_global[PACKET_MAX_PL_LEN];
 static mutex_t send_buffer_mutex;
+static uint8_t lzo_buffer[PACKET_MAX_PL_LEN] __attribute__((aligned(8)));
+static mutex_t lzo_mutex;
 static mutex_t print_mutex;
 static mutex_t terminal_mutex;
 static uint8_t blocking_thread_cmd_buffer[PACKET_MAX_PL_LEN];
@@ -49,6 +57,10 @@ static THD_FUNCTION(blocking_thread, arg);
 static THD_WORKING_AREA(blocking_thread_wa, 2048);
 static thread_t *blocking_tp;
 
+// Private functions
+static void send_packet_seg(void(*reply_func)(unsigned char *data, unsigned int len),
+		const packet_seg_t *segs, int seg_num);
+
 // Function pointers
 static void(* volatile send_func)(unsigned char *data, unsigned int len) = 0;
 static void(* volatile send_func_blocking)(unsigned char *data, unsigned int len) = 0;
@@ -56,6 +68,7 @@ static void(* volatile appdata_func)(unsigned char *data, unsigned int len) = 0;
 
 void commands_init(void) {
 	chMtxObjectInit(&send_buffer_mutex);
+	chMtxObjectInit(&lzo_mutex);
 	chMtxObjectInit(&print_mutex);
 	chMtxObjectInit(&terminal_mutex);
 	chThdCreateStatic(blocking_thread_wa, sizeof(blocking_thread_wa), NORMALPRIO, blocking_thread, NULL);
@@ -245,6 +258,41 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 		reply_func(send_buffer, ind);
 	} break;
 
+	case COMM_WRITE_NEW_APP_DATA_LZO: {
+		// Same as COMM_WRITE_NEW_APP_DATA, with the chunk compressed as one
+		// LZO1X block after its decompressed length.
+		if (len < 9) {
+			break;
+		}
+
+		int32_t ind = 0;
+		uint32_t new_app_offset = buffer_get_uint32(data, &ind);
+		uint32_t decompressed_len = buffer_get_uint16(data, &ind);
+		uint16_t flash_res = HAL_ERROR;
+
+		// Own buffer, as the write can wait for the erase and would block
+		// the users of send_buffer_global meanwhile
+		chMtxLock(&lzo_mutex);
+		uint32_t out_len = sizeof(lzo_buffer) - 8;
+		if (lzo_decompress(data + ind, len - ind, lzo_buffer, &out_len) == LZO_E_OK &&
+				out_len == decompressed_len) {
+			// Pad to multiple of 8 bytes
+			while ((out_len % 8) != 0) {
+				lzo_buffer[out_len++] = 0;
+			}
+
+			flash_res = flash_helper_write_new_app_data(new_app_offset, lzo_buffer, out_len);
+		}
+		chMtxUnlock(&lzo_mutex);
+
+		ind = 0;
+		uint8_t send_buffer[50];
+		send_buffer[ind++] = COMM_WRITE_NEW_APP_DATA_LZO;
+		send_buffer[ind++] = flash_res == HAL_OK ? 1 : 0;
+		buffer_append_uint32(send_buffer, new_app_offset, &ind);
+		reply_func(send_buffer, ind);
+	} break;
+
 	case COMM_FORWARD_CAN:
 		comm_can_send_buffer(data[0], data + 1, len - 1, 0);
 		break;
@@ -285,8 +333,9 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 		if (conf_ind == 0 && confparser_deserialize_main_config_t(data + 1, conf)) {
 			conf_general_apply_hw_limits(conf);
 			backup.config = *conf;
-			flash_helper_store_backup_data();
+			conf_general_store_config();
 			comm_can_set_baud(backup.config.can_baud_rate);
+			comm_can_update_filters();
 
 			int32_t ind = 0;
 			uint8_t send_buffer[50];
@@ -315,17 +364,18 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 			break;
 		}
 
-		chMtxLock(&send_buffer_mutex);
+		uint8_t header[10];
 		ind = 0;
-		send_buffer_global[ind++] = packet_id;
-		send_buffer_global[ind++] = conf_ind;
-		buffer_append_int32(send_buffer_global, DATA_MAIN_CONFIG_T__SIZE, &ind);
-		buffer_append_int32(send_buffer_global, ofs_conf, &ind);
-		memcpy(send_buffer_global + ind, data_main_config_t_ + ofs_conf, len_conf);
-		ind += len_conf;
-		reply_func(send_buffer_global, ind);
-
-		chMtxUnlock(&send_buffer_mutex);
+		header[ind++] = packet_id;
+		header[ind++] = conf_ind;
+		buffer_append_int32(header, DATA_MAIN_CONFIG_T__SIZE, &ind);
+		buffer_append_int32(header, ofs_conf, &ind);
+
+		packet_seg_t segs[2] = {
+				{header, ind},
+				{data_main_config_t_ + ofs_conf, len_conf}
+		};
+		send_packet_seg(reply_func, segs, 2);
 	} break;
 
 	case COMM_TERMINAL_CMD_SYNC:
@@ -341,15 +391,7 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 		bool by_id = data[ind++];
 		int id_ind = buffer_get_int16(data, &ind);
 
-		int psws_num = 0;
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			psw_status *stat = comm_can_get_psw_status_index(i);
-			if (stat->id >= 0) {
-				psws_num++;
-			} else {
-				break;
-			}
-		}
+		int psws_num = comm_can_get_psw_status_num();
 
 		psw_status *stat = 0;
 		if (by_id) {
@@ -389,6 +431,135 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 		HW_SEND_DATA(reply_func);
 	} break;
 
+	case COMM_RES_ENERGY: {
+		energy_stats stats[2];
+		energy_get_session(&stats[0]);
+		energy_get_total(&stats[1]);
+
+		int32_t ind = 0;
+		uint8_t send_buffer[120];
+		send_buffer[ind++] = packet_id;
+		send_buffer[ind++] = ENERGY_DUTY_BINS;
+
+		for (int i = 0;i < 2;i++) {
+			buffer_append_float32_auto(send_buffer, stats[i].wh, &ind);
+			buffer_append_float32_auto(send_buffer, stats[i].ah, &ind);
+			buffer_append_float32_auto(send_buffer, stats[i].peak_power, &ind);
+			for (int j = 0;j < ENERGY_DUTY_BINS;j++) {
+				buffer_append_float32_auto(send_buffer, stats[i].duty_time[j], &ind);
+			}
+		}
+
+		reply_func(send_buffer, ind);
+	} break;
+
+	case COMM_RES_ENERGY_RESET: {
+		// Optional argument to also reset the lifetime totals
+		energy_reset_session();
+		if (len > 0 && data[0]) {
+			energy_reset_total();
+		}
+	} break;
+
+	case COMM_RES_TELEMETRY: {
+		if (len < 3) {
+			break;
+		}
+
+		int32_t ind = 0;
+		bool start = data[ind++];
+		int decimation = buffer_get_uint16(data, &ind);
+
+		if (start) {
+			telemetry_start(decimation);
+		} else {
+			telemetry_stop();
+		}
+	} break;
+
+	case COMM_RES_CAPTURE:
+		capture_process_packet(data, len, reply_func);
+		break;
+
+	case COMM_RES_CAN_STATS: {
+		// Optional mode: 0 summary, 1 frames per packet type, 2 reset and summary
+		int mode = len > 0 ? data[0] : 0;
+
+		if (mode == 1) {
+			static uint32_t counts[CAN_RX_TYPES];
+			comm_can_get_rx_type_counts(counts);
+
+			int32_t ind = 0;
+			uint8_t send_buffer[CAN_RX_TYPES * 5 + 2];
+			send_buffer[ind++] = packet_id;
+			send_buffer[ind++] = mode;
+			for (int i = 0;i < CAN_RX_TYPES;i++) {
+				if (counts[i] > 0) {
+					send_buffer[ind++] = i;
+					buffer_append_uint32(send_buffer, counts[i], &ind);
+				}
+			}
+			reply_func(send_buffer, ind);
+			break;
+		}
+
+		if (mode == 2) {
+			comm_can_reset_stats();
+		}
+
+		can_stats stats;
+		comm_can_get_stats(&stats);
+
+		int32_t ind = 0;
+		uint8_t send_buffer[160];
+		send_buffer[ind++] = packet_id;
+		buffer_append_uint32(send_buffer, stats.rx_frames, &ind);
+		buffer_append_uint32(send_buffer, stats.rx_dropped, &ind);
+		buffer_append_uint32(send_buffer, stats.rx_overruns, &ind);
+		buffer_append_uint32(send_buffer, stats.tx_frames, &ind);
+		for (int i = 0;i < CAN_TX_PRIO_NUM;i++) {
+			buffer_append_uint32(send_buffer, stats.tx_dropped[i], &ind);
+			buffer_append_uint32(send_buffer, stats.tx_latency_avg_us[i], &ind);
+			buffer_append_uint32(send_buffer, stats.tx_latency_max_us[i], &ind);
+		}
+		buffer_append_uint32(send_buffer, stats.tx_bulk_stalls, &ind);
+		buffer_append_uint32(send_buffer, stats.err_warning, &ind);
+		buffer_append_uint32(send_buffer, stats.err_passive, &ind);
+		buffer_append_uint32(send_buffer, stats.err_bus_off, &ind);
+		buffer_append_uint32(send_buffer, stats.err_framing, &ind);
+		send_buffer[ind++] = stats.tec;
+		send_buffer[ind++] = stats.rec;
+		buffer_append_uint32(send_buffer, stats.rx_queue_max, &ind);
+		for (int i = 0;i < CAN_TX_PRIO_NUM;i++) {
+			buffer_append_uint32(send_buffer, stats.tx_queue_max[i], &ind);
+		}
+		buffer_append_float32_auto(send_buffer, stats.rx_rate, &ind);
+		buffer_append_float32_auto(send_buffer, stats.tx_rate, &ind);
+		buffer_append_float32_auto(send_buffer, stats.bus_load, &ind);
+		for (int i = 0;i < CAN_TX_LAT_BINS;i++) {
+			buffer_append_uint32(send_buffer, stats.tx_latency_hist[i], &ind);
+		}
+		reply_func(send_buffer, ind);
+	} break;
+
+	case COMM_RES_CONF_STORE: {
+		// Optional mode: 0 status, 1 write a pending configuration now
+		int mode = len > 0 ? data[0] : 0;
+
+		if (mode == 1) {
+			conf_general_commit_config();
+		}
+
+		int32_t ind = 0;
+		uint8_t send_buffer[16];
+		send_buffer[ind++] = packet_id;
+		send_buffer[ind++] = conf_general_store_pending();
+		buffer_append_uint32(send_buffer, conf_general_store_pending_age_ms(), &ind);
+		buffer_append_uint16(send_buffer, backup.config.conf_store_delay_ms, &ind);
+		buffer_append_uint32(send_buffer, backup.conf_flash_write_cnt, &ind);
+		reply_func(send_buffer, ind);
+	} break;
+
 	case COMM_CUSTOM_APP_DATA: {
 		if (appdata_func) {
 			appdata_func(data, len);
@@ -457,16 +628,51 @@ void commands_set_app_data_handler(void(*func)(unsigned char *data, unsigned int
 }
 
 void commands_send_app_data(unsigned char *data, unsigned int len) {
-	int32_t index = 0;
+	if (len > (PACKET_MAX_PL_LEN - 1) || !send_func) {
+		return;
+	}
+
+	uint8_t header = COMM_CUSTOM_APP_DATA;
+	packet_seg_t segs[2] = {
+			{&header, 1},
+			{data, len}
+	};
+	send_packet_seg(send_func, segs, 2);
+}
+
+/*
+ * Send a packet given as segments. USB and UART frame the segments directly
+ * from where they are. Other transports, such as CAN, take a single buffer,
+ * so for them the segments are gathered in send_buffer_global first.
+ */
+static void send_packet_seg(void(*reply_func)(unsigned char *data, unsigned int len),
+		const packet_seg_t *segs, int seg_num) {
+#if HAL_USE_USB
+	if (reply_func == comm_usb_send_packet) {
+		comm_usb_send_packet_seg(segs, seg_num);
+		return;
+	}
+#endif
 
-	if (len > PACKET_MAX_PL_LEN)
+#ifdef HW_UART_DEV
+	if (reply_func == comm_uart_send_packet) {
+		comm_uart_send_packet_seg(segs, seg_num);
 		return;
+	}
+#endif
 
 	chMtxLock(&send_buffer_mutex);
-	send_buffer_global[index++] = COMM_CUSTOM_APP_DATA;
-	memcpy(send_buffer_global + index, data, len);
-	index += len;
-	commands_send_packet(send_buffer_global, index);
+	unsigned int ind = 0;
+	for (int i = 0;i < seg_num;i++) {
+		if ((ind + segs[i].len) > PACKET_MAX_PL_LEN) {
+			chMtxUnlock(&send_buffer_mutex);
+			return;
+		}
+
+		memcpy(send_buffer_global + ind, segs[i].data, segs[i].len);
+		ind += segs[i].len;
+	}
+	reply_func(send_buffer_global, ind);
 	chMtxUnlock(&send_buffer_mutex);
 }
 
@@ -504,12 +710,7 @@ static THD_FUNCTION(blocking_thread, arg) {
 			int32_t ind = 0;
 			send_buffer[ind++] = COMM_PING_CAN;
 
-			for (uint8_t i = 0;i < 255;i++) {
-				HW_TYPE hw_type;
-				if (comm_can_ping(i, &hw_type)) {
-					send_buffer[ind++] = i;
-				}
-			}
+			ind += comm_can_scan(send_buffer + ind, 0, 255);
 
 			if (send_func_blocking) {
 				send_func_blocking(send_buffer, ind);
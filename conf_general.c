@@ -19,9 +19,117 @@
 
 #include "conf_general.h"
 #include "utils.h"
+#include "main.h"
+#include "flash_helper.h"
+#include "terminal.h"
+#include "commands.h"
+
+// Threads
+static THD_WORKING_AREA(store_thread_wa, 512);
+static THD_FUNCTION(store_thread, arg);
+
+// Private functions
+static void terminal_conf_store(int argc, const char **argv);
+
+// Private variables
+static volatile bool m_store_pending = false;
+static volatile systime_t m_change_time = 0;
+static volatile uint32_t m_change_write_cnt = 0;
+
+void conf_general_init(void) {
+	chThdCreateStatic(store_thread_wa, sizeof(store_thread_wa), NORMALPRIO - 2, store_thread, NULL);
+
+	terminal_register_command_callback(
+			"conf_store",
+			"Write a pending configuration to flash now",
+			0,
+			terminal_conf_store);
+}
 
 void conf_general_apply_hw_limits(main_config_t *config) {
 	(void)config;
 }
 
+/**
+ * Persist the configuration in backup after it has been changed. The new
+ * configuration has to be applied already, this only schedules the flash
+ * write for when the configuration has been unchanged for
+ * conf_store_delay_ms, so that a burst of changes only results in one write.
+ */
+void conf_general_store_config(void) {
+	if (backup.config.conf_store_delay_ms == 0) {
+		flash_helper_store_backup_data();
+		return;
+	}
+
+	chSysLock();
+	m_change_time = chVTGetSystemTimeX();
+	m_change_write_cnt = backup.conf_flash_write_cnt;
+	m_store_pending = true;
+	chSysUnlock();
+}
+
+/**
+ * Write a pending configuration to flash without waiting for the delay.
+ */
+void conf_general_commit_config(void) {
+	if (conf_general_store_pending()) {
+		flash_helper_store_backup_data();
+	}
+}
+
+/**
+ * Check if the configuration in RAM has not been written to flash yet.
+ *
+ * @return
+ * true if a flash write is pending.
+ */
+bool conf_general_store_pending(void) {
+	// Any write since the change, e.g. from the energy accounting, has
+	// stored the new configuration as well. The counter is incremented
+	// before the data is copied, so comparing it is enough.
+	return m_store_pending && backup.conf_flash_write_cnt == m_change_write_cnt;
+}
+
+/**
+ * Get the time since the configuration was last changed.
+ *
+ * @return
+ * The time in milliseconds, 0 when nothing is pending.
+ */
+uint32_t conf_general_store_pending_age_ms(void) {
+	if (!conf_general_store_pending()) {
+		return 0;
+	}
+
+	return TIME_I2MS(chVTTimeElapsedSinceX(m_change_time));
+}
+
+static THD_FUNCTION(store_thread, arg) {
+	(void)arg;
+
+	chRegSetThreadName("Conf Store");
+
+	for (;;) {
+		if (conf_general_store_pending() && conf_general_store_pending_age_ms() >=
+				backup.config.conf_store_delay_ms) {
+			conf_general_commit_config();
+		}
+
+		chThdSleepMilliseconds(50);
+	}
+}
+
+static void terminal_conf_store(int argc, const char **argv) {
+	(void)argc;
+	(void)argv;
+
+	if (conf_general_store_pending()) {
+		conf_general_commit_config();
+		commands_printf("Configuration written to flash\n");
+	} else {
+		commands_printf("No pending configuration\n");
+	}
+}
+
 
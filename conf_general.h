@@ -63,6 +63,11 @@
 #include "conf_default.h"
 
 // Functions
+void conf_general_init(void);
 void conf_general_apply_hw_limits(main_config_t *config);
+void conf_general_store_config(void);
+void conf_general_commit_config(void);
+bool conf_general_store_pending(void);
+uint32_t conf_general_store_pending_age_ms(void);
 
 #endif /* CONF_GENERAL_H_ */
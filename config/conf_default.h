@@ -53,6 +53,126 @@
 #define CONF_LOAD_VOLT_MAX_FRACTION 0
 #endif
 
+// Load Control Mode
+#ifndef CONF_LOAD_CTRL_MODE
+#define CONF_LOAD_CTRL_MODE 0
+#endif
+
+// Load PI Kp
+#ifndef CONF_LOAD_PI_KP
+#define CONF_LOAD_PI_KP 0.2
+#endif
+
+// Load PI Ki
+#ifndef CONF_LOAD_PI_KI
+#define CONF_LOAD_PI_KI 15
+#endif
+
+// Load Resistance
+#ifndef CONF_LOAD_RES
+#define CONF_LOAD_RES 5
+#endif
+
+// Thermal Model
+#ifndef CONF_TMOD_EN
+#define CONF_TMOD_EN 0
+#endif
+
+// Element Heat Capacity
+#ifndef CONF_TMOD_C_ELEMENT
+#define CONF_TMOD_C_ELEMENT 50
+#endif
+
+// Element Thermal Resistance
+#ifndef CONF_TMOD_R_ELEMENT
+#define CONF_TMOD_R_ELEMENT 0.5
+#endif
+
+// Heatsink Heat Capacity
+#ifndef CONF_TMOD_C_HS
+#define CONF_TMOD_C_HS 500
+#endif
+
+// Heatsink Thermal Resistance
+#ifndef CONF_TMOD_R_HS
+#define CONF_TMOD_R_HS 0.2
+#endif
+
+// Electrical Deadband Voltage
+#ifndef CONF_CAN_STAT_ELEC_DB_V
+#define CONF_CAN_STAT_ELEC_DB_V 0
+#endif
+
+// Electrical Deadband Current
+#ifndef CONF_CAN_STAT_ELEC_DB_I
+#define CONF_CAN_STAT_ELEC_DB_I 0
+#endif
+
+// Thermal Rate
+#ifndef CONF_CAN_STAT_THERM_RATE_HZ
+#define CONF_CAN_STAT_THERM_RATE_HZ 1
+#endif
+
+// Thermal Deadband
+#ifndef CONF_CAN_STAT_THERM_DB
+#define CONF_CAN_STAT_THERM_DB 2
+#endif
+
+// Energy Rate
+#ifndef CONF_CAN_STAT_ENERGY_RATE_HZ
+#define CONF_CAN_STAT_ENERGY_RATE_HZ 1
+#endif
+
+// Limits Rate
+#ifndef CONF_CAN_STAT_LIMITS_RATE_HZ
+#define CONF_CAN_STAT_LIMITS_RATE_HZ 1
+#endif
+
+// Duty Rate
+#ifndef CONF_CAN_STAT_DUTY_RATE_HZ
+#define CONF_CAN_STAT_DUTY_RATE_HZ 0
+#endif
+
+// Duty Deadband
+#ifndef CONF_CAN_STAT_DUTY_DB
+#define CONF_CAN_STAT_DUTY_DB 0.05
+#endif
+
+// Minimum Interval
+#ifndef CONF_CAN_STAT_MIN_INTERVAL_MS
+#define CONF_CAN_STAT_MIN_INTERVAL_MS 10
+#endif
+
+// Regen Feed-Forward
+#ifndef CONF_FF_EN
+#define CONF_FF_EN 0
+#endif
+
+// First Controller ID
+#ifndef CONF_FF_ID_FIRST
+#define CONF_FF_ID_FIRST 0
+#endif
+
+// Last Controller ID
+#ifndef CONF_FF_ID_LAST
+#define CONF_FF_ID_LAST 254
+#endif
+
+// Feed-Forward Gain
+#ifndef CONF_FF_GAIN
+#define CONF_FF_GAIN 0.9
+#endif
+
+// Status Timeout
+#ifndef CONF_FF_TIMEOUT_MS
+#define CONF_FF_TIMEOUT_MS 100
+#endif
+
+// Config Store Delay
+#ifndef CONF_CONF_STORE_DELAY_MS
+#define CONF_CONF_STORE_DELAY_MS 2000
+#endif
+
 // CONF_DEFAULT_H_
 #endif
 
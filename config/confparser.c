@@ -20,6 +20,30 @@ int32_t confparser_serialize_main_config_t(uint8_t *buffer, const main_config_t
 	buffer_append_float32_auto(buffer, conf->load_volt_start, &ind);
 	buffer_append_float32_auto(buffer, conf->load_volt_max, &ind);
 	buffer_append_float32_auto(buffer, conf->load_volt_max_fraction, &ind);
+	buffer[ind++] = conf->load_ctrl_mode;
+	buffer_append_float32_auto(buffer, conf->load_pi_kp, &ind);
+	buffer_append_float32_auto(buffer, conf->load_pi_ki, &ind);
+	buffer_append_float32_auto(buffer, conf->load_res, &ind);
+	buffer[ind++] = conf->tmod_en;
+	buffer_append_float32_auto(buffer, conf->tmod_c_element, &ind);
+	buffer_append_float32_auto(buffer, conf->tmod_r_element, &ind);
+	buffer_append_float32_auto(buffer, conf->tmod_c_hs, &ind);
+	buffer_append_float32_auto(buffer, conf->tmod_r_hs, &ind);
+	buffer_append_float32_auto(buffer, conf->can_stat_elec_db_v, &ind);
+	buffer_append_float32_auto(buffer, conf->can_stat_elec_db_i, &ind);
+	buffer_append_uint16(buffer, conf->can_stat_therm_rate_hz, &ind);
+	buffer_append_float32_auto(buffer, conf->can_stat_therm_db, &ind);
+	buffer_append_uint16(buffer, conf->can_stat_energy_rate_hz, &ind);
+	buffer_append_uint16(buffer, conf->can_stat_limits_rate_hz, &ind);
+	buffer_append_uint16(buffer, conf->can_stat_duty_rate_hz, &ind);
+	buffer_append_float32_auto(buffer, conf->can_stat_duty_db, &ind);
+	buffer_append_uint16(buffer, conf->can_stat_min_interval_ms, &ind);
+	buffer[ind++] = conf->ff_en;
+	buffer[ind++] = (uint8_t)conf->ff_id_first;
+	buffer[ind++] = (uint8_t)conf->ff_id_last;
+	buffer_append_float32_auto(buffer, conf->ff_gain, &ind);
+	buffer_append_uint16(buffer, conf->ff_timeout_ms, &ind);
+	buffer_append_uint16(buffer, conf->conf_store_delay_ms, &ind);
 
 	return ind;
 }
@@ -42,6 +66,30 @@ bool confparser_deserialize_main_config_t(const uint8_t *buffer, main_config_t *
 	conf->load_volt_start = buffer_get_float32_auto(buffer, &ind);
 	conf->load_volt_max = buffer_get_float32_auto(buffer, &ind);
 	conf->load_volt_max_fraction = buffer_get_float32_auto(buffer, &ind);
+	conf->load_ctrl_mode = buffer[ind++];
+	conf->load_pi_kp = buffer_get_float32_auto(buffer, &ind);
+	conf->load_pi_ki = buffer_get_float32_auto(buffer, &ind);
+	conf->load_res = buffer_get_float32_auto(buffer, &ind);
+	conf->tmod_en = buffer[ind++];
+	conf->tmod_c_element = buffer_get_float32_auto(buffer, &ind);
+	conf->tmod_r_element = buffer_get_float32_auto(buffer, &ind);
+	conf->tmod_c_hs = buffer_get_float32_auto(buffer, &ind);
+	conf->tmod_r_hs = buffer_get_float32_auto(buffer, &ind);
+	conf->can_stat_elec_db_v = buffer_get_float32_auto(buffer, &ind);
+	conf->can_stat_elec_db_i = buffer_get_float32_auto(buffer, &ind);
+	conf->can_stat_therm_rate_hz = buffer_get_uint16(buffer, &ind);
+	conf->can_stat_therm_db = buffer_get_float32_auto(buffer, &ind);
+	conf->can_stat_energy_rate_hz = buffer_get_uint16(buffer, &ind);
+	conf->can_stat_limits_rate_hz = buffer_get_uint16(buffer, &ind);
+	conf->can_stat_duty_rate_hz = buffer_get_uint16(buffer, &ind);
+	conf->can_stat_duty_db = buffer_get_float32_auto(buffer, &ind);
+	conf->can_stat_min_interval_ms = buffer_get_uint16(buffer, &ind);
+	conf->ff_en = buffer[ind++];
+	conf->ff_id_first = buffer[ind++];
+	conf->ff_id_last = buffer[ind++];
+	conf->ff_gain = buffer_get_float32_auto(buffer, &ind);
+	conf->ff_timeout_ms = buffer_get_uint16(buffer, &ind);
+	conf->conf_store_delay_ms = buffer_get_uint16(buffer, &ind);
 
 	return true;
 }
@@ -57,5 +105,29 @@ void confparser_set_defaults_main_config_t(main_config_t *conf) {
 	conf->load_volt_start = CONF_LOAD_VOLT_START;
 	conf->load_volt_max = CONF_LOAD_VOLT_MAX;
 	conf->load_volt_max_fraction = CONF_LOAD_VOLT_MAX_FRACTION;
+	conf->load_ctrl_mode = CONF_LOAD_CTRL_MODE;
+	conf->load_pi_kp = CONF_LOAD_PI_KP;
+	conf->load_pi_ki = CONF_LOAD_PI_KI;
+	conf->load_res = CONF_LOAD_RES;
+	conf->tmod_en = CONF_TMOD_EN;
+	conf->tmod_c_element = CONF_TMOD_C_ELEMENT;
+	conf->tmod_r_element = CONF_TMOD_R_ELEMENT;
+	conf->tmod_c_hs = CONF_TMOD_C_HS;
+	conf->tmod_r_hs = CONF_TMOD_R_HS;
+	conf->can_stat_elec_db_v = CONF_CAN_STAT_ELEC_DB_V;
+	conf->can_stat_elec_db_i = CONF_CAN_STAT_ELEC_DB_I;
+	conf->can_stat_therm_rate_hz = CONF_CAN_STAT_THERM_RATE_HZ;
+	conf->can_stat_therm_db = CONF_CAN_STAT_THERM_DB;
+	conf->can_stat_energy_rate_hz = CONF_CAN_STAT_ENERGY_RATE_HZ;
+	conf->can_stat_limits_rate_hz = CONF_CAN_STAT_LIMITS_RATE_HZ;
+	conf->can_stat_duty_rate_hz = CONF_CAN_STAT_DUTY_RATE_HZ;
+	conf->can_stat_duty_db = CONF_CAN_STAT_DUTY_DB;
+	conf->can_stat_min_interval_ms = CONF_CAN_STAT_MIN_INTERVAL_MS;
+	conf->ff_en = CONF_FF_EN;
+	conf->ff_id_first = CONF_FF_ID_FIRST;
+	conf->ff_id_last = CONF_FF_ID_LAST;
+	conf->ff_gain = CONF_FF_GAIN;
+	conf->ff_timeout_ms = CONF_FF_TIMEOUT_MS;
+	conf->conf_store_delay_ms = CONF_CONF_STORE_DELAY_MS;
 }
 
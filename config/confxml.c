@@ -2,110 +2,259 @@
 
 #include "confxml.h"
 
-uint8_t data_main_config_t_[1670] = {
-	0x00, 0x00, 0x41, 0x15, 0x78, 0xda, 0xed, 0x9c, 0xdd, 0x72, 0xda, 0x46, 0x14, 0xc7, 0xef, 0xf3, 
-	0x14, 0x5b, 0xcf, 0x34, 0xb9, 0x29, 0x48, 0x10, 0x68, 0x1a, 0xac, 0x90, 0xc1, 0x80, 0x13, 0x4f, 
-	0xf9, 0xf0, 0x80, 0xec, 0xb4, 0xbd, 0xd1, 0x2c, 0xd2, 0x02, 0x3b, 0x95, 0x56, 0xf2, 0x6a, 0x31, 
-	0x90, 0x4e, 0xdf, 0xa9, 0xcf, 0xd0, 0x27, 0xeb, 0xee, 0x4a, 0x7c, 0x48, 0x08, 0x01, 0x19, 0x30, 
-	0xb4, 0x95, 0xc7, 0x63, 0xa4, 0xb3, 0xe7, 0xec, 0x4a, 0x47, 0xe7, 0xfc, 0xf4, 0x37, 0x16, 0xd6, 
-	0x3e, 0xce, 0x1c, 0x1b, 0x3c, 0x23, 0xea, 0x63, 0x97, 0x7c, 0xb8, 0x2a, 0xe4, 0xd5, 0x2b, 0x80, 
-	0x88, 0xe9, 0x5a, 0x98, 0x8c, 0x3e, 0x5c, 0x3d, 0xe8, 0xb7, 0xb9, 0x9f, 0xae, 0x3e, 0x56, 0x5f, 
-	0x69, 0x75, 0x97, 0x0c, 0xf1, 0xe8, 0x1e, 0x52, 0xe8, 0xf8, 0xd5, 0x57, 0x80, 0x7f, 0x69, 0xeb, 
-	0x3b, 0xd2, 0x60, 0x4a, 0x1f, 0x83, 0x40, 0x07, 0xad, 0xac, 0x72, 0xc4, 0x76, 0xc9, 0xa8, 0x23, 
-	0xcc, 0xc4, 0x25, 0x48, 0x53, 0x96, 0xbb, 0x51, 0x2f, 0x36, 0xf7, 0x50, 0xf5, 0xad, 0xa6, 0xc8, 
-	0xd7, 0xd8, 0x10, 0x85, 0xc4, 0x77, 0x30, 0x63, 0x70, 0x60, 0xa3, 0xaa, 0xca, 0x7d, 0x22, 0x86, 
-	0xa8, 0xb3, 0x85, 0x7c, 0x93, 0x62, 0x8f, 0xf1, 0x33, 0xaa, 0xbe, 0xb6, 0xd9, 0xf5, 0x77, 0x8d, 
-	0x6e, 0x5d, 0xff, 0xf5, 0xbe, 0x09, 0x3e, 0xeb, 0xed, 0x16, 0xb8, 0x7f, 0xb8, 0x69, 0xdd, 0xd5, 
-	0xc1, 0xeb, 0xa7, 0x89, 0xcb, 0xae, 0x73, 0x8a, 0xf2, 0xe5, 0x6d, 0x5d, 0x51, 0x1a, 0x7a, 0x23, 
-	0x18, 0x2d, 0xe5, 0x55, 0x45, 0x69, 0x76, 0x82, 0xd1, 0xd0, 0x69, 0xcc, 0x98, 0x57, 0x51, 0x94, 
-	0xe9, 0x74, 0x9a, 0x9f, 0xbe, 0xcd, 0xbb, 0x74, 0xa4, 0xe8, 0x3d, 0xa5, 0xd7, 0xac, 0xe7, 0xc6, 
-	0xcc, 0xb1, 0x4b, 0xaa, 0xe2, 0x33, 0x8a, 0x4d, 0x96, 0xb7, 0x98, 0x15, 0xf8, 0xbf, 0x1e, 0xb1, 
-	0xeb, 0x57, 0x62, 0x61, 0x31, 0x2e, 0x76, 0xe4, 0x36, 0x82, 0xd6, 0x62, 0xdb, 0x41, 0x0c, 0x02, 
-	0x91, 0xa6, 0x0f, 0x41, 0xc0, 0x13, 0x8f, 0x1f, 0x33, 0x34, 0x63, 0xe1, 0xb2, 0x3c, 0x91, 0x0c, 
-	0x11, 0x16, 0x8e, 0x16, 0x42, 0xab, 0xb2, 0x08, 0xf7, 0xd9, 0xdc, 0x46, 0x40, 0x64, 0x29, 0xf4, 
-	0x10, 0xa1, 0x8a, 0xe9, 0xfb, 0x6b, 0xcb, 0x7b, 0x3f, 0x00, 0x1b, 0x83, 0x3f, 0xc0, 0x74, 0x8c, 
-	0x19, 0xca, 0xf9, 0x1e, 0x34, 0x51, 0x05, 0x78, 0x14, 0xe5, 0xa6, 0x14, 0x7a, 0xd7, 0xe0, 0x4f, 
-	0x79, 0x7c, 0x8a, 0x9c, 0x69, 0x31, 0xad, 0xb2, 0x7e, 0x88, 0x03, 0xd7, 0x9a, 0x03, 0x39, 0x1c, 
-	0xae, 0x01, 0x86, 0xfc, 0xa0, 0x72, 0x43, 0xe8, 0x60, 0x7b, 0x5e, 0x79, 0xd3, 0x73, 0x07, 0x2e, 
-	0x73, 0xdf, 0x5c, 0x83, 0xd0, 0x3e, 0x45, 0x78, 0x34, 0x66, 0x95, 0x92, 0xaa, 0x86, 0x06, 0x19, 
-	0x5a, 0x21, 0x2e, 0x75, 0xa0, 0x7d, 0x1d, 0x4b, 0x8b, 0x17, 0x9d, 0xd8, 0x81, 0x74, 0x84, 0x49, 
-	0x8e, 0xb9, 0x5e, 0x45, 0xf5, 0x66, 0xcb, 0x7d, 0xbe, 0x00, 0x73, 0x9d, 0x88, 0xc9, 0x46, 0x43, 
-	0x16, 0x31, 0x50, 0xb9, 0xaa, 0xb4, 0xe4, 0x9e, 0x58, 0x6e, 0x60, 0xbb, 0xe6, 0xef, 0x39, 0x4c, 
-	0x2c, 0x9e, 0xbc, 0x0a, 0x3f, 0x12, 0x91, 0x97, 0xe5, 0x2e, 0x77, 0x5a, 0x1d, 0x87, 0xde, 0x6d, 
-	0x74, 0xe5, 0x39, 0x7b, 0xcb, 0xb3, 0x17, 0x67, 0xbc, 0x4a, 0x45, 0x78, 0xe5, 0x34, 0x65, 0xbd, 
-	0x98, 0xa2, 0x65, 0x66, 0x36, 0xd0, 0x10, 0x13, 0x54, 0xd5, 0x94, 0xc5, 0x56, 0x74, 0xfc, 0x19, 
-	0xda, 0x7d, 0x5e, 0x19, 0x64, 0x54, 0x75, 0x20, 0x26, 0x46, 0xd8, 0x1d, 0x4c, 0x53, 0x56, 0x03, 
-	0xd1, 0x00, 0x07, 0xce, 0x5a, 0x88, 0x88, 0xea, 0x0e, 0xb7, 0x56, 0xad, 0xa5, 0x24, 0xf6, 0x96, 
-	0x36, 0x9e, 0xa6, 0x76, 0xdb, 0x63, 0xb3, 0x5f, 0x07, 0x2d, 0x17, 0x5a, 0xe9, 0x2d, 0xa7, 0x66, 
-	0x2d, 0x97, 0xb5, 0xdc, 0xc9, 0x5b, 0x4e, 0xa6, 0xd1, 0x83, 0x24, 0xe5, 0x14, 0xfb, 0xbc, 0xc0, 
-	0x40, 0x1f, 0x51, 0x3c, 0x7c, 0xb3, 0xde, 0xab, 0x63, 0xec, 0x03, 0xfe, 0xcd, 0xc6, 0x08, 0xc8, 
-	0x8a, 0xbe, 0x69, 0xf7, 0xf3, 0xa0, 0xef, 0x3a, 0x08, 0x8c, 0xa7, 0x3c, 0xcf, 0xc8, 0xc4, 0x43, 
-	0x6c, 0x02, 0x4c, 0x86, 0x2e, 0x98, 0x62, 0xdb, 0x06, 0x03, 0x04, 0xa0, 0x65, 0x21, 0x0b, 0x8c, 
-	0x11, 0x45, 0xf9, 0x20, 0xeb, 0x7c, 0xe1, 0x65, 0xd2, 0x4f, 0xd3, 0xf3, 0x9a, 0xb2, 0xd1, 0x8d, 
-	0xe2, 0x8e, 0xc8, 0xa8, 0x6b, 0xdb, 0x88, 0x1a, 0xd8, 0xda, 0xd6, 0xa5, 0xf5, 0x5a, 0x07, 0xdc, 
-	0x35, 0xd2, 0x5b, 0xb4, 0xb8, 0x47, 0x8b, 0x16, 0xb2, 0x16, 0xcd, 0x5a, 0xf4, 0x3c, 0x2d, 0x1a, 
-	0x94, 0x70, 0x1e, 0x3c, 0xf8, 0xbc, 0xeb, 0x98, 0x0b, 0xb0, 0x98, 0x1c, 0x0f, 0xe7, 0xbc, 0x67, 
-	0x79, 0xe3, 0xca, 0xa6, 0xb5, 0xf9, 0x6d, 0x08, 0xb8, 0x44, 0x76, 0x31, 0x77, 0xcf, 0x0d, 0x26, 
-	0xfe, 0x69, 0x5a, 0xb3, 0xde, 0xed, 0xdc, 0x1a, 0xfc, 0x87, 0xde, 0xeb, 0xb6, 0x5a, 0xcd, 0x9e, 
-	0x21, 0x5a, 0x2b, 0xf9, 0x06, 0x8d, 0x2c, 0xcc, 0x5c, 0xda, 0x37, 0x61, 0xd0, 0x3c, 0xeb, 0xbb, 
-	0x9b, 0x8e, 0x35, 0xff, 0x1e, 0x51, 0x93, 0x9f, 0x16, 0x1c, 0xc9, 0xbb, 0xe1, 0x86, 0x6d, 0xe3, 
-	0x5e, 0x7e, 0x47, 0x58, 0xb5, 0x58, 0x2e, 0xcb, 0xbb, 0xb9, 0xd8, 0x8e, 0x39, 0x60, 0x22, 0x8c, 
-	0x39, 0xbe, 0x70, 0xb8, 0x19, 0x1d, 0xf7, 0xc7, 0xee, 0xb4, 0x81, 0x7d, 0xcf, 0x86, 0x73, 0xb1, 
-	0xdc, 0xfa, 0x6e, 0xcc, 0x91, 0x21, 0x4f, 0x84, 0xf3, 0x89, 0x16, 0x9b, 0x1b, 0x3a, 0x44, 0x8e, 
-	0xab, 0x25, 0x29, 0x3d, 0x12, 0x96, 0x9a, 0x0c, 0x87, 0x78, 0xc6, 0x99, 0x16, 0x6e, 0xc4, 0xc2, 
-	0xf5, 0x99, 0x98, 0x5b, 0xbc, 0x44, 0xf5, 0x48, 0x12, 0xd9, 0x34, 0x1f, 0x11, 0xcb, 0x30, 0x21, 
-	0x31, 0x7c, 0x06, 0xd9, 0xc4, 0x37, 0x28, 0x64, 0xc8, 0x18, 0x7f, 0x4d, 0x63, 0x5f, 0x5f, 0x7a, 
-	0x82, 0x1e, 0xf7, 0xcc, 0x20, 0x98, 0x41, 0xf0, 0x5f, 0x0b, 0xc1, 0x3e, 0x2f, 0x7d, 0x10, 0x94, 
-	0x3d, 0x70, 0x90, 0xef, 0x73, 0x28, 0xf8, 0x31, 0xe2, 0x01, 0xc8, 0x02, 0x24, 0x8a, 0xb6, 0x38, 
-	0x21, 0xfe, 0xfa, 0xcd, 0x4e, 0xc3, 0xe0, 0x6b, 0x1a, 0x7d, 0xbd, 0xa6, 0x3f, 0xf4, 0x8d, 0x5e, 
-	0x4d, 0x6f, 0x1a, 0x9f, 0x7f, 0x3b, 0x27, 0x08, 0x55, 0x55, 0x4d, 0x27, 0xa1, 0xfa, 0x72, 0x20, 
-	0x4c, 0xe7, 0x20, 0xf8, 0xfc, 0x35, 0x05, 0x85, 0xe5, 0x0d, 0x14, 0xee, 0x44, 0x9e, 0x26, 0x06, 
-	0x07, 0x70, 0x62, 0xc9, 0xa1, 0x34, 0x14, 0xde, 0x70, 0xa7, 0x3d, 0x40, 0x58, 0xca, 0x40, 0x98, 
-	0x81, 0xf0, 0xa2, 0xd5, 0xa0, 0x84, 0x9d, 0x28, 0xf9, 0x53, 0x93, 0x4e, 0x40, 0xee, 0xa6, 0xf6, 
-	0xd0, 0x90, 0x88, 0x4b, 0x79, 0x27, 0x46, 0x32, 0x68, 0x4b, 0xdf, 0x23, 0x32, 0x71, 0x44, 0xab, 
-	0xf9, 0xd5, 0xe5, 0x6c, 0x85, 0x62, 0xf9, 0x67, 0x8e, 0xb6, 0xe5, 0xc0, 0xce, 0x80, 0x62, 0x59, 
-	0x3d, 0x2c, 0xa0, 0xac, 0x1e, 0x18, 0x50, 0x68, 0x1f, 0xe6, 0x7e, 0xe0, 0xf4, 0xc5, 0x83, 0x8f, 
-	0xff, 0x30, 0xff, 0x77, 0x5b, 0x12, 0xca, 0xaf, 0x59, 0x32, 0x1d, 0x35, 0x86, 0x1c, 0xcf, 0xb0, 
-	0xb1, 0x23, 0xb8, 0x4a, 0xd9, 0x36, 0x6c, 0xea, 0xdc, 0x0b, 0xb4, 0x30, 0xc7, 0x9c, 0x10, 0x92, 
-	0x94, 0xa5, 0x93, 0xb3, 0x90, 0x91, 0x33, 0x23, 0xe7, 0xe9, 0xdf, 0x5d, 0xe6, 0x35, 0x89, 0x78, 
-	0x35, 0x4f, 0x28, 0x12, 0x8a, 0x8f, 0x67, 0xc9, 0x1c, 0x03, 0xcf, 0x9d, 0x22, 0xca, 0xd3, 0xc6, 
-	0xcb, 0x0a, 0x93, 0x11, 0x18, 0x20, 0xbe, 0x84, 0x7f, 0x54, 0x16, 0xea, 0xcd, 0xf6, 0xbd, 0xd1, 
-	0xba, 0x6b, 0x0b, 0xd5, 0xd7, 0xd3, 0xd3, 0xc5, 0x5e, 0x03, 0x99, 0x98, 0x27, 0xcf, 0x6f, 0xb8, 
-	0x93, 0xc1, 0xba, 0xea, 0x8b, 0xd9, 0x5f, 0x54, 0x27, 0x86, 0x6b, 0xbe, 0x0f, 0x84, 0x62, 0xe2, 
-	0x11, 0x70, 0x85, 0x18, 0xda, 0x73, 0xc5, 0x40, 0x30, 0x26, 0xba, 0x1d, 0xa4, 0x19, 0x57, 0x29, 
-	0x58, 0xdb, 0xdb, 0xb8, 0x81, 0x84, 0xf6, 0x1f, 0x03, 0xf1, 0x98, 0xec, 0xa5, 0x87, 0x07, 0xbd, 
-	0xcc, 0x50, 0xcc, 0x92, 0x2c, 0x37, 0xff, 0xfe, 0xab, 0x9e, 0xa2, 0x37, 0xdf, 0x6f, 0xe8, 0xcd, 
-	0x6d, 0x5c, 0x5c, 0x01, 0x93, 0x0b, 0xd2, 0x3d, 0x70, 0xd9, 0x24, 0x56, 0x06, 0xcb, 0x0c, 0x96, 
-	0x17, 0x0c, 0x4b, 0xfe, 0x8b, 0xb2, 0xe9, 0x3a, 0x9e, 0x8d, 0x18, 0xb2, 0xe7, 0xc0, 0xc2, 0xbe, 
-	0xa8, 0x30, 0xeb, 0x34, 0xcc, 0xe4, 0xbf, 0x31, 0x67, 0xc4, 0x3c, 0x05, 0x31, 0xdf, 0x5d, 0x10, 
-	0x31, 0x23, 0x60, 0xd4, 0x9e, 0x5d, 0x9b, 0x19, 0xb6, 0xa8, 0xb4, 0xdd, 0x32, 0xf3, 0x91, 0xfb, 
-	0xf2, 0x4b, 0x90, 0x29, 0xcd, 0x0c, 0x9e, 0x97, 0x04, 0xcf, 0x45, 0x59, 0xbe, 0xa0, 0xca, 0x7c, 
-	0xec, 0xb6, 0x74, 0xa3, 0xd5, 0xfd, 0xd2, 0xec, 0xfd, 0x6f, 0xb4, 0x66, 0xa1, 0x74, 0x0e, 0x70, 
-	0x16, 0x8f, 0x0f, 0xce, 0xc7, 0x83, 0xb0, 0x99, 0xce, 0xc7, 0x38, 0x3e, 0x53, 0x44, 0x67, 0x14, 
-	0x9e, 0x99, 0xee, 0xcc, 0xd0, 0x79, 0xb9, 0xe8, 0x7c, 0x01, 0xcd, 0x19, 0x23, 0xe8, 0x7f, 0x5f, 
-	0x79, 0x9e, 0x87, 0x9f, 0x85, 0xf2, 0x65, 0xf1, 0x33, 0x2a, 0x3e, 0xc5, 0xf3, 0x10, 0x86, 0xf4, 
-	0xd8, 0x4f, 0x77, 0x8a, 0xc7, 0x27, 0x32, 0xd9, 0x99, 0xb1, 0xf3, 0x32, 0xd9, 0x29, 0x9f, 0xee, 
-	0x91, 0x85, 0xec, 0x83, 0x11, 0x62, 0x52, 0x7b, 0x42, 0xcf, 0xb3, 0xf1, 0x91, 0xd1, 0xd9, 0xea, 
-	0xd6, 0x1a, 0x01, 0x3f, 0x33, 0xdd, 0x79, 0x2a, 0x6e, 0x96, 0xce, 0xad, 0x3b, 0xb7, 0xa2, 0x71, 
-	0x0d, 0x9a, 0x3c, 0x79, 0x7b, 0x21, 0xb3, 0x0d, 0x67, 0x19, 0x30, 0x33, 0x60, 0x5e, 0x1c, 0x30, 
-	0x79, 0xfd, 0x62, 0x67, 0xe2, 0x04, 0xe0, 0xe4, 0x9a, 0xf3, 0xb4, 0xb0, 0x6c, 0xd7, 0x7e, 0xc9, 
-	0x50, 0x79, 0x02, 0x54, 0x96, 0x2f, 0x07, 0x95, 0x11, 0x20, 0x46, 0x41, 0x69, 0x0c, 0x29, 0x34, 
-	0x13, 0x8a, 0x65, 0x2b, 0x31, 0xc1, 0x6d, 0x18, 0x90, 0xa1, 0x33, 0x43, 0xe7, 0xb9, 0xd1, 0x29, 
-	0x8b, 0x92, 0x73, 0x73, 0x41, 0xcc, 0xe7, 0xa0, 0x58, 0x4f, 0x47, 0x4a, 0xe3, 0xb6, 0x57, 0xab, 
-	0xeb, 0x77, 0xdd, 0xce, 0x41, 0xc8, 0x2c, 0x9e, 0x18, 0x99, 0x85, 0x03, 0x90, 0x59, 0xd8, 0x87, 
-	0x98, 0x7b, 0xfe, 0x31, 0xa8, 0xb0, 0x27, 0x30, 0xd5, 0xbc, 0x5a, 0xdc, 0x8b, 0x99, 0xc7, 0x47, 
-	0xe6, 0xf7, 0xdf, 0x8e, 0xcc, 0x18, 0x1a, 0x35, 0x25, 0xf2, 0x09, 0xd7, 0x3e, 0xa2, 0x5d, 0x6a, 
-	0x21, 0x1a, 0x79, 0xbe, 0x9d, 0x56, 0x23, 0xcf, 0xbe, 0x8b, 0xe7, 0x3f, 0xe3, 0x0e, 0x5b, 0x9e, 
-	0x08, 0x4d, 0x72, 0x8d, 0x3c, 0xfc, 0x94, 0xe4, 0x10, 0xfd, 0x6b, 0x7f, 0xaa, 0x07, 0x22, 0x89, 
-	0x47, 0x93, 0xf4, 0x36, 0xee, 0x1e, 0x7e, 0x5b, 0x66, 0x8b, 0x89, 0xf3, 0x74, 0x17, 0x47, 0xa8, 
-	0xef, 0x1d, 0x0e, 0xcb, 0x4b, 0xb0, 0xe6, 0xa9, 0x29, 0xd1, 0xd4, 0x6b, 0x9f, 0xa8, 0x3b, 0xf1, 
-	0x22, 0x9f, 0x98, 0xd4, 0x46, 0xc2, 0x14, 0xbb, 0xe2, 0xd2, 0x26, 0x6f, 0x57, 0x9f, 0x10, 0x41, 
-	0x14, 0xda, 0x9a, 0xb2, 0x32, 0xc5, 0x8b, 0x67, 0x90, 0x30, 0x43, 0x64, 0x48, 0x46, 0xc9, 0xf7, 
-	0xac, 0x7d, 0x51, 0x61, 0x83, 0x2d, 0x53, 0x45, 0x62, 0xe2, 0x1f, 0x8a, 0x8e, 0x38, 0x79, 0x62, 
-	0x70, 0xe3, 0x8a, 0x06, 0xd6, 0xbd, 0x22, 0xe4, 0x35, 0xd9, 0xed, 0x9f, 0x7c, 0xc5, 0x0f, 0x8e, 
-	0x4b, 0x5b, 0x6d, 0x95, 0x90, 0xa4, 0x33, 0x5e, 0x8d, 0x7e, 0x63, 0xd6, 0xeb, 0xb5, 0xce, 0x31, 
-	0x53, 0x1e, 0xeb, 0xd8, 0xdd, 0x99, 0xd8, 0xda, 0xc1, 0xbb, 0x43, 0x63, 0x1d, 0x7d, 0x9e, 0xfc, 
-	0x05, 0x1f, 0xfa, 0x3d, 0x5e, 0x02, 0x37, 0xba, 0x7e, 0x77, 0x1e, 0x62, 0x14, 0x38, 0x30, 0x60, 
-	0x8d, 0x0a, 0x47, 0xcb, 0x60, 0x08, 0x83, 0x05, 0x62, 0x56, 0x4c, 0xd1, 0x94, 0xe8, 0xbf, 0x37, 
-	0xf8, 0x07, 0xd2, 0xcc, 0x2a, 0xa9, 
+uint8_t data_main_config_t_[4062] = {
+	0x00, 0x00, 0xc7, 0x6f, 0x78, 0xda, 0xed, 0x9d, 0xed, 0x92, 0xda, 0xc8, 0xd5, 0xc7, 0xbf, 0xef, 
+	0x55, 0x74, 0xb6, 0x2a, 0xbb, 0x4f, 0xaa, 0x3c, 0xbc, 0x8c, 0x3d, 0x49, 0xd6, 0x66, 0x27, 0x35, 
+	0x06, 0xc6, 0xe6, 0x31, 0xcc, 0x4c, 0x01, 0xf6, 0x66, 0xf3, 0x45, 0xd5, 0x48, 0x0d, 0x74, 0x59, 
+	0x2f, 0xac, 0xba, 0x19, 0x4c, 0x52, 0xb9, 0xa0, 0x7c, 0xcb, 0x35, 0xe4, 0x02, 0x72, 0x4d, 0x39, 
+	0xa7, 0x5b, 0x02, 0x24, 0x24, 0x01, 0x5e, 0x18, 0x31, 0x49, 0x6f, 0x79, 0x6d, 0xe8, 0x3e, 0xdd, 
+	0x92, 0x9a, 0xd3, 0x3f, 0xfd, 0xfb, 0x45, 0x47, 0x8d, 0x3f, 0x7d, 0xf1, 0x5c, 0xf2, 0xc8, 0x42, 
+	0xc1, 0x03, 0xff, 0xc7, 0x6f, 0xeb, 0x95, 0xda, 0xb7, 0x84, 0xf9, 0x76, 0xe0, 0x70, 0x7f, 0xf2, 
+	0xe3, 0xb7, 0x1f, 0x87, 0xb7, 0x17, 0x7f, 0xfc, 0xf6, 0x4f, 0xd7, 0xdf, 0x34, 0x9a, 0x81, 0x3f, 
+	0xe6, 0x93, 0x07, 0x1a, 0x52, 0x4f, 0x5c, 0x7f, 0x43, 0xe0, 0xbf, 0xc6, 0xe6, 0x17, 0x95, 0x60, 
+	0x2b, 0x1b, 0xcb, 0xa7, 0x1e, 0x5b, 0xa7, 0xaa, 0x1c, 0x37, 0xf0, 0x27, 0x77, 0x98, 0xec, 0x07, 
+	0x3e, 0x6b, 0x54, 0x57, 0x5f, 0x93, 0x56, 0x72, 0x39, 0x63, 0xd7, 0x2f, 0x1b, 0x55, 0xf5, 0x6f, 
+	0x2a, 0x2b, 0xa4, 0xbe, 0xf0, 0xb8, 0x94, 0x74, 0xe4, 0xb2, 0xeb, 0x1a, 0xd8, 0x24, 0x12, 0x92, 
+	0xc6, 0x0e, 0x13, 0x76, 0xc8, 0x67, 0x12, 0xae, 0xe8, 0xfa, 0x3b, 0x57, 0xbe, 0xf9, 0x4d, 0xeb, 
+	0xbe, 0x39, 0xfc, 0xf9, 0xa1, 0x4d, 0xde, 0x0f, 0x7b, 0x5d, 0xf2, 0xf0, 0xf1, 0x6d, 0xb7, 0xd3, 
+	0x24, 0xdf, 0xfd, 0x32, 0x0f, 0xe4, 0x9b, 0x8b, 0x6a, 0xf5, 0xa7, 0x97, 0xcd, 0x6a, 0xb5, 0x35, 
+	0x6c, 0xe9, 0xdc, 0x57, 0x95, 0x5a, 0xb5, 0xda, 0xbe, 0xd3, 0xb9, 0x91, 0xd1, 0x54, 0xca, 0xd9, 
+	0xeb, 0x6a, 0x75, 0xb1, 0x58, 0x54, 0x16, 0x2f, 0x2b, 0x41, 0x38, 0xa9, 0x0e, 0xfb, 0xd5, 0x7e, 
+	0xbb, 0x79, 0x31, 0x95, 0x9e, 0xfb, 0xaa, 0x56, 0x15, 0x32, 0xe4, 0xb6, 0xac, 0x38, 0xd2, 0xd1, 
+	0xf6, 0xdf, 0x4d, 0xe4, 0x9b, 0x6f, 0xf0, 0xc0, 0x98, 0x8f, 0x5f, 0xd4, 0x67, 0x46, 0x9d, 0xf8, 
+	0xb3, 0xc7, 0x24, 0x25, 0xd8, 0x4c, 0x3f, 0xea, 0x02, 0xbf, 0x40, 0xf9, 0xa9, 0x64, 0x5f, 0x64, 
+	0x74, 0x58, 0x68, 0x48, 0xc9, 0x7c, 0x19, 0xe5, 0xd6, 0xa3, 0xd4, 0x6a, 0x5c, 0x5c, 0xc8, 0xa5, 
+	0xcb, 0x08, 0xb6, 0x52, 0x64, 0x81, 0x45, 0xab, 0xb6, 0x10, 0x1b, 0x87, 0x9f, 0xbd, 0x20, 0x2e, 
+	0x27, 0x7f, 0x23, 0x8b, 0x29, 0x97, 0xec, 0x42, 0xcc, 0xa8, 0xcd, 0x5e, 0x93, 0x59, 0xc8, 0x2e, 
+	0x16, 0x21, 0x9d, 0xbd, 0x21, 0x7f, 0x57, 0xe7, 0x57, 0x55, 0x35, 0xc5, 0xd5, 0x56, 0x37, 0x4f, 
+	0x71, 0x14, 0x38, 0x4b, 0xa2, 0xb2, 0xa3, 0x63, 0x90, 0x31, 0x9c, 0xd4, 0xc5, 0x98, 0x7a, 0xdc, 
+	0x5d, 0xbe, 0xfe, 0xbe, 0x1f, 0x8c, 0x02, 0x19, 0x7c, 0xff, 0x86, 0x44, 0xe9, 0x0b, 0xc6, 0x27, 
+	0x53, 0xf9, 0xfa, 0x55, 0xad, 0x16, 0x25, 0xa8, 0xa2, 0xaf, 0xfd, 0x20, 0xf4, 0xa8, 0xfb, 0x26, 
+	0xd5, 0x2c, 0xb3, 0x64, 0xc5, 0x1e, 0x0d, 0x27, 0xdc, 0xbf, 0x90, 0xc1, 0xec, 0x75, 0x6d, 0xf6, 
+	0x65, 0xf5, 0x1d, 0x0e, 0x20, 0x03, 0x2f, 0x91, 0xe4, 0xb2, 0xb1, 0x4c, 0x24, 0x84, 0xea, 0xa8, 
+	0x2a, 0xe5, 0xe2, 0x17, 0x79, 0x31, 0x72, 0x03, 0xfb, 0xf3, 0x05, 0xf7, 0x1d, 0x68, 0xbc, 0xd7, 
+	0x70, 0x26, 0xd8, 0x2e, 0xab, 0xaf, 0x60, 0xb4, 0x3e, 0x8f, 0xe1, 0x7d, 0xeb, 0x5e, 0x5d, 0xf3, 
+	0x6c, 0x75, 0xf5, 0x78, 0xc5, 0xeb, 0xa6, 0x88, 0x7e, 0xb9, 0x46, 0x75, 0xd3, 0x99, 0x92, 0x6e, 
+	0x66, 0xb7, 0xd8, 0x98, 0xfb, 0xec, 0xba, 0x51, 0x8d, 0x3f, 0x25, 0xf3, 0x1f, 0xa9, 0x3b, 0x00, 
+	0xcf, 0xf0, 0x27, 0xd7, 0x1e, 0xe5, 0xbe, 0x15, 0xf5, 0x0e, 0xd9, 0xa8, 0xae, 0x33, 0x92, 0x05, 
+	0x3c, 0xfa, 0xa5, 0xcb, 0x7c, 0xf4, 0xee, 0xe8, 0xd3, 0xba, 0x6b, 0x55, 0x33, 0xfb, 0x56, 0x63, 
+	0xba, 0x28, 0xec, 0x6d, 0x9f, 0xda, 0x83, 0x26, 0xe9, 0x06, 0xd4, 0x29, 0xee, 0x72, 0x35, 0xd3, 
+	0xe5, 0x4c, 0x97, 0x3b, 0x79, 0x97, 0x53, 0xcd, 0x38, 0xa3, 0x7e, 0xc1, 0x25, 0x0e, 0xc0, 0xc1, 
+	0xc8, 0x80, 0x85, 0x7c, 0xfc, 0xfd, 0x66, 0x5f, 0x9d, 0x72, 0x41, 0xe0, 0x8f, 0x9c, 0x32, 0xa2, 
+	0x3c, 0xfa, 0x6d, 0x6f, 0x50, 0x21, 0x83, 0xc0, 0x63, 0x64, 0xba, 0x80, 0x76, 0x66, 0x36, 0x1f, 
+	0x73, 0x9b, 0x70, 0x7f, 0x1c, 0x90, 0x05, 0x77, 0x5d, 0x32, 0x62, 0x84, 0x3a, 0x0e, 0x73, 0xc8, 
+	0x94, 0x85, 0xac, 0xa2, 0x5b, 0x1d, 0x0e, 0xbc, 0x6a, 0xf4, 0xd3, 0xf4, 0xf9, 0x46, 0x75, 0xab, 
+	0x37, 0xe2, 0x1d, 0x51, 0x86, 0x81, 0xeb, 0xb2, 0xd0, 0xe2, 0x4e, 0x5e, 0x2f, 0x6d, 0xde, 0xdc, 
+	0x91, 0x4e, 0xab, 0xb8, 0x8b, 0x5e, 0xee, 0xd1, 0x45, 0xeb, 0xa6, 0x8b, 0x9a, 0x2e, 0x5a, 0x4e, 
+	0x17, 0xd5, 0x2e, 0x5c, 0x21, 0x1f, 0x05, 0xf4, 0x3a, 0x19, 0x10, 0x8e, 0x95, 0xf3, 0xf1, 0x12, 
+	0xfa, 0x2c, 0x74, 0x5c, 0xd5, 0x69, 0x5d, 0xb8, 0x0d, 0x91, 0xc0, 0x57, 0xbd, 0x18, 0xcc, 0x2f, 
+	0x46, 0x73, 0x71, 0x9a, 0xae, 0xd9, 0xbc, 0xbf, 0xbb, 0xb5, 0xe0, 0xaf, 0x61, 0xff, 0xbe, 0xdb, 
+	0x6d, 0xf7, 0x2d, 0xec, 0x5a, 0xd9, 0x37, 0x68, 0xe6, 0x70, 0x19, 0x84, 0x03, 0x9b, 0xea, 0xce, 
+	0xb3, 0xf9, 0x75, 0xdb, 0xf0, 0x46, 0x3c, 0xb0, 0xd0, 0x86, 0xcb, 0xa2, 0x13, 0x75, 0x37, 0xdc, 
+	0x4a, 0xdb, 0xba, 0x97, 0x77, 0x7c, 0x79, 0x7d, 0x79, 0x75, 0xa5, 0xee, 0xe6, 0xf8, 0x39, 0x65, 
+	0xc0, 0x7d, 0x4c, 0xbc, 0x80, 0x03, 0x47, 0x1f, 0x93, 0xf9, 0x62, 0x1a, 0x2c, 0x5a, 0x5c, 0xcc, 
+	0x5c, 0xba, 0xc4, 0xc3, 0x6d, 0x7e, 0x4d, 0x19, 0x4a, 0x36, 0xc3, 0xe2, 0x50, 0x51, 0xfc, 0x71, 
+	0x4b, 0x87, 0xa8, 0xfc, 0xda, 0x2b, 0x25, 0x3d, 0x32, 0x0e, 0x35, 0x1f, 0x8f, 0xf9, 0x17, 0x60, 
+	0x5a, 0xf4, 0x21, 0x55, 0x7c, 0xf8, 0x05, 0xeb, 0xc6, 0x7f, 0x92, 0x7a, 0x24, 0x8b, 0x6c, 0x0d, 
+	0xc1, 0x7c, 0xc7, 0xb2, 0xa9, 0x6f, 0x09, 0x49, 0xe5, 0x5c, 0x58, 0x21, 0x95, 0xcc, 0x9a, 0xfe, 
+	0xb5, 0x88, 0x7d, 0x03, 0x65, 0x49, 0xfa, 0x60, 0x69, 0x20, 0x68, 0x20, 0xf8, 0x6c, 0x21, 0x38, 
+	0x00, 0xd7, 0x27, 0xda, 0xed, 0x89, 0xc7, 0x84, 0x00, 0x28, 0x88, 0x14, 0xf1, 0x08, 0x95, 0x1a, 
+	0x89, 0xd8, 0x2d, 0x4e, 0x88, 0xbf, 0x41, 0xfb, 0xae, 0x65, 0xc1, 0x31, 0xad, 0xc1, 0xf0, 0x66, 
+	0xf8, 0x71, 0x60, 0xf5, 0x6f, 0x86, 0x6d, 0xeb, 0xfd, 0x5f, 0xca, 0x04, 0x61, 0xad, 0x56, 0x2b, 
+	0x26, 0x61, 0xed, 0xe9, 0x40, 0x58, 0xcc, 0x41, 0xf2, 0xfe, 0xaf, 0x05, 0x28, 0xbc, 0xda, 0x42, 
+	0xe1, 0x4e, 0xe4, 0x35, 0x30, 0x73, 0x44, 0xe7, 0x8e, 0xca, 0x2a, 0x42, 0xe1, 0x5b, 0x30, 0xda, 
+	0x03, 0x84, 0xaf, 0x0c, 0x08, 0x0d, 0x08, 0xcf, 0x5a, 0x0d, 0x2a, 0xd8, 0xa1, 0xcb, 0x9f, 0x9a, 
+	0x74, 0x08, 0xb9, 0xb7, 0x37, 0x1f, 0x5b, 0x0a, 0x71, 0x05, 0x33, 0x31, 0x8a, 0x41, 0x39, 0xfd, 
+	0x9e, 0xf9, 0x73, 0x0f, 0xbb, 0x9a, 0xb8, 0x5e, 0xd5, 0x56, 0xbf, 0xbc, 0xfa, 0x00, 0x68, 0x5b, 
+	0x65, 0xec, 0x2c, 0x70, 0x79, 0x55, 0x3b, 0xac, 0xc0, 0x55, 0xed, 0xc0, 0x02, 0xf5, 0xde, 0x61, 
+	0xe6, 0x07, 0x56, 0x7f, 0x79, 0xf0, 0xf9, 0x1f, 0x66, 0xff, 0x87, 0x9c, 0x06, 0x85, 0xdf, 0x2c, 
+	0x9b, 0x8e, 0x0d, 0xc9, 0xbc, 0x99, 0xe5, 0x72, 0x0f, 0xb9, 0x1a, 0xca, 0x3c, 0x6c, 0x0e, 0xc1, 
+	0x8a, 0x74, 0x39, 0x60, 0x0e, 0x85, 0x64, 0x28, 0x8b, 0xc9, 0x59, 0x37, 0xe4, 0x34, 0xe4, 0x3c, 
+	0xfd, 0xec, 0x32, 0xf8, 0x24, 0x03, 0x6f, 0x9e, 0x87, 0x0c, 0x15, 0x1f, 0xb4, 0x92, 0x3d, 0x25, 
+	0xb3, 0x60, 0xc1, 0x42, 0x68, 0x36, 0x70, 0x2b, 0xee, 0x4f, 0xc8, 0x88, 0xc1, 0x21, 0xc4, 0x51, 
+	0x59, 0x38, 0x6c, 0xf7, 0x1e, 0xac, 0x6e, 0xa7, 0x87, 0xaa, 0xaf, 0x3f, 0x2c, 0x16, 0x7b, 0x2d, 
+	0x66, 0x73, 0x68, 0x3c, 0xd1, 0x0a, 0xe6, 0xa3, 0x4d, 0xd5, 0x97, 0x4a, 0x7f, 0x52, 0x9d, 0x18, 
+	0x1d, 0xf3, 0x07, 0x2d, 0x14, 0x33, 0xcf, 0x00, 0x14, 0x62, 0x94, 0x7e, 0x71, 0xa9, 0x05, 0x63, 
+	0xa6, 0xd9, 0x41, 0x9a, 0x71, 0xdd, 0x04, 0x1b, 0xdf, 0xb6, 0x6e, 0x20, 0x51, 0xfa, 0xef, 0xb5, 
+	0x78, 0xcc, 0xb6, 0x1a, 0x46, 0x27, 0xbd, 0x6a, 0xa1, 0x54, 0x4a, 0xb6, 0xdc, 0xfc, 0xd7, 0x3f, 
+	0x9b, 0x05, 0x7a, 0xf3, 0x87, 0x2d, 0xbd, 0x99, 0xc7, 0xc5, 0x35, 0x30, 0x41, 0x90, 0xee, 0x81, 
+	0xcb, 0xb6, 0xef, 0x18, 0x58, 0x1a, 0x58, 0x9e, 0x31, 0x2c, 0x61, 0xa0, 0x6c, 0x07, 0xde, 0xcc, 
+	0x65, 0x92, 0xb9, 0x4b, 0xe2, 0x70, 0x81, 0x1e, 0xe6, 0x9c, 0x86, 0x99, 0x30, 0x62, 0x36, 0xc4, 
+	0x3c, 0x05, 0x31, 0xff, 0x70, 0x46, 0xc4, 0x4c, 0x80, 0xb1, 0xf1, 0x18, 0xb8, 0xd2, 0x72, 0xd1, 
+	0xd3, 0x76, 0xcb, 0xcc, 0x4f, 0x60, 0x0b, 0x3f, 0x81, 0x51, 0x9a, 0x06, 0x9e, 0xe7, 0x04, 0xcf, 
+	0xd8, 0x2d, 0x9f, 0x50, 0x65, 0x7e, 0xba, 0xef, 0x0e, 0xad, 0xee, 0xfd, 0x4f, 0xed, 0xfe, 0xff, 
+	0x8c, 0xd6, 0xac, 0xbf, 0x2a, 0x03, 0x9c, 0x97, 0xc7, 0x07, 0xe7, 0xa7, 0x83, 0xb0, 0x59, 0xcc, 
+	0xc7, 0x34, 0x3e, 0x0b, 0x44, 0x67, 0x12, 0x9e, 0x46, 0x77, 0x1a, 0x74, 0x9e, 0x2f, 0x3a, 0x9f, 
+	0x40, 0x73, 0xa6, 0x08, 0xfa, 0xdf, 0xaf, 0x3c, 0xcb, 0xe1, 0x67, 0xfd, 0xea, 0xbc, 0xf8, 0x99, 
+	0x14, 0x9f, 0xb8, 0x1f, 0xc2, 0x52, 0x16, 0xfb, 0xe9, 0x4e, 0xdc, 0x3e, 0x61, 0x64, 0xa7, 0x61, 
+	0xe7, 0x79, 0xb2, 0x53, 0xed, 0xee, 0x51, 0x8e, 0x2c, 0xc8, 0x84, 0x49, 0xa5, 0x3d, 0xe9, 0x6c, 
+	0xe6, 0xf2, 0x23, 0xa3, 0xb3, 0x7b, 0x7f, 0xd3, 0xd2, 0xfc, 0x34, 0xba, 0xf3, 0x54, 0xdc, 0x7c, 
+	0x55, 0xb6, 0xee, 0xcc, 0x45, 0xe3, 0x06, 0x34, 0xa1, 0xf1, 0xf6, 0x42, 0x66, 0x8f, 0x7e, 0x31, 
+	0xc0, 0x34, 0xc0, 0x3c, 0x3b, 0x60, 0x82, 0xff, 0x72, 0x6f, 0xee, 0x69, 0x70, 0x82, 0xe6, 0x3c, 
+	0x2d, 0x2c, 0x7b, 0x37, 0x7f, 0x36, 0xa8, 0x3c, 0x01, 0x2a, 0xaf, 0xce, 0x07, 0x95, 0x09, 0x20, 
+	0x26, 0x41, 0x69, 0x8d, 0x43, 0x6a, 0x67, 0x38, 0x4b, 0x2e, 0x31, 0xc9, 0x6d, 0x54, 0xc0, 0xa0, 
+	0xd3, 0xa0, 0xb3, 0x6c, 0x74, 0x2a, 0xa7, 0x04, 0x6e, 0xc6, 0xc4, 0x7c, 0xd4, 0xce, 0x7a, 0x3a, 
+	0x52, 0x5a, 0xb7, 0xfd, 0x9b, 0xe6, 0xb0, 0x73, 0x7f, 0x77, 0x10, 0x32, 0x2f, 0x4f, 0x8c, 0xcc, 
+	0xfa, 0x01, 0xc8, 0xac, 0xef, 0x43, 0xcc, 0x3d, 0x17, 0x83, 0xea, 0x7b, 0x02, 0xb3, 0x56, 0xa9, 
+	0x5d, 0xee, 0xc5, 0xcc, 0xe3, 0x23, 0xf3, 0xb7, 0x5f, 0x8f, 0xcc, 0x0c, 0x34, 0x6a, 0x76, 0xda, 
+	0x32, 0x74, 0x2d, 0x2f, 0x70, 0x72, 0xb7, 0x6b, 0x2a, 0xb7, 0x6c, 0xea, 0x5d, 0xf0, 0xa4, 0x07, 
+	0x86, 0x66, 0xcb, 0xa6, 0x61, 0x65, 0xe9, 0xac, 0x04, 0x58, 0xd1, 0xf0, 0xb5, 0xda, 0x72, 0x1e, 
+	0x2b, 0xcb, 0x90, 0x7a, 0x33, 0xe6, 0x40, 0xb3, 0x61, 0x96, 0xbb, 0x24, 0xe3, 0x30, 0xf0, 0xc8, 
+	0xf6, 0xb4, 0x12, 0x3e, 0xb6, 0x93, 0xd6, 0x01, 0x15, 0xf2, 0xd0, 0xd1, 0x95, 0xe1, 0x76, 0xce, 
+	0x08, 0xbc, 0xaa, 0x4e, 0x36, 0x99, 0xbb, 0x54, 0xea, 0x87, 0x7d, 0x32, 0xea, 0x5a, 0x70, 0x39, 
+	0x25, 0x14, 0x4a, 0x93, 0xf5, 0x73, 0x22, 0x2f, 0xc8, 0x5c, 0xe0, 0xb4, 0x40, 0xae, 0xd8, 0x20, 
+	0x54, 0x3f, 0xe3, 0xb7, 0x29, 0x8d, 0x2b, 0xc7, 0xc7, 0x7c, 0x73, 0xd8, 0xef, 0x5a, 0xbd, 0xfb, 
+	0xd6, 0xae, 0xdd, 0xa2, 0xb5, 0x9d, 0xbb, 0x45, 0x75, 0x6b, 0xef, 0xb3, 0x0b, 0xf2, 0xa1, 0x93, 
+	0xb3, 0xf7, 0x31, 0x8f, 0x35, 0x1a, 0x42, 0x33, 0x6e, 0x7d, 0x9e, 0x15, 0x02, 0x08, 0x5a, 0xf8, 
+	0xc3, 0xcc, 0xa8, 0x34, 0x43, 0x9e, 0xb2, 0xc9, 0xf3, 0x10, 0x06, 0xb3, 0x20, 0x44, 0x0f, 0xa1, 
+	0x2e, 0x99, 0x50, 0xee, 0x93, 0x60, 0xbc, 0x45, 0x8e, 0x08, 0x1b, 0x41, 0x48, 0x20, 0x1f, 0x5c, 
+	0x17, 0x7d, 0xbe, 0x42, 0x3e, 0xfa, 0x5c, 0x22, 0x54, 0x9c, 0xb9, 0x5c, 0x12, 0x7b, 0x69, 0xc3, 
+	0x4f, 0x31, 0x63, 0xa1, 0x2a, 0x84, 0x95, 0x04, 0x8f, 0x2c, 0x8c, 0x2a, 0x38, 0x01, 0x0d, 0x1e, 
+	0x3a, 0xd6, 0x87, 0x87, 0x83, 0x84, 0xde, 0xcb, 0x33, 0x1a, 0x1b, 0x5f, 0x1d, 0x51, 0xe8, 0xd5, 
+	0xf6, 0x17, 0x7a, 0xfb, 0x0d, 0x8e, 0x6b, 0x95, 0xcb, 0xa3, 0x4b, 0xbd, 0xea, 0x57, 0x0c, 0x8f, 
+	0x53, 0x14, 0x5d, 0xa3, 0x95, 0xef, 0x44, 0x2b, 0x37, 0x68, 0x35, 0x68, 0x2d, 0x1b, 0xad, 0x20, 
+	0x41, 0xd8, 0x24, 0x3c, 0x2a, 0x56, 0x05, 0x83, 0x9f, 0xcd, 0x79, 0x1a, 0xba, 0x76, 0xce, 0x6a, 
+	0x18, 0x7d, 0x08, 0x5d, 0xeb, 0xf1, 0x33, 0x8b, 0x4f, 0x0b, 0xd8, 0xd2, 0x56, 0xb7, 0xab, 0x9f, 
+	0xc4, 0xd7, 0xd1, 0x95, 0xa7, 0xe9, 0x1a, 0x6e, 0x69, 0xe1, 0x24, 0x5b, 0xfb, 0x4c, 0x70, 0x21, 
+	0xa9, 0x6f, 0x33, 0x03, 0x58, 0x03, 0xd8, 0xb2, 0x01, 0xbb, 0xf6, 0xc6, 0x15, 0x5d, 0x43, 0xfa, 
+	0x19, 0xc7, 0xaa, 0xa1, 0xca, 0x01, 0xb0, 0x32, 0x97, 0x79, 0x50, 0x70, 0x1d, 0xe1, 0x02, 0xba, 
+	0x91, 0xad, 0x86, 0xc0, 0xca, 0xde, 0xe1, 0x42, 0xf0, 0x99, 0x1a, 0x10, 0xeb, 0x5d, 0x44, 0x63, 
+	0x28, 0x83, 0x19, 0xf0, 0x3f, 0x5e, 0xb4, 0x42, 0xb2, 0x7b, 0x02, 0xc0, 0xf6, 0xdb, 0x83, 0xe7, 
+	0x8c, 0xd7, 0xbd, 0xe8, 0x5a, 0xa9, 0x1f, 0x5b, 0xc0, 0xee, 0xb9, 0xb8, 0x73, 0x74, 0xc0, 0xfe, 
+	0xfb, 0x1f, 0x87, 0xf3, 0x35, 0x81, 0xd2, 0x86, 0x04, 0x47, 0xb2, 0x58, 0xee, 0x42, 0xce, 0x30, 
+	0x72, 0x37, 0x9c, 0x8f, 0x74, 0x8b, 0xd1, 0x7a, 0x65, 0xd0, 0x6a, 0xd0, 0x7a, 0x72, 0xb4, 0xb6, 
+	0x85, 0x04, 0xcc, 0x44, 0x94, 0x94, 0x1b, 0x4f, 0xfa, 0x44, 0xa0, 0x4d, 0x03, 0x56, 0xcf, 0x4e, 
+	0x66, 0x22, 0x95, 0x82, 0x60, 0xc5, 0x55, 0xf2, 0xe5, 0x56, 0x5d, 0x6a, 0xb7, 0xbb, 0x40, 0x2a, 
+	0x63, 0x0e, 0x8b, 0x0f, 0xc9, 0x7d, 0xe8, 0xe4, 0x54, 0xab, 0x5c, 0x1f, 0x8b, 0xe9, 0x7c, 0x8f, 
+	0x51, 0x01, 0xa5, 0x9c, 0xcd, 0x2a, 0x2a, 0x44, 0x05, 0x19, 0xa3, 0xae, 0x1b, 0x2c, 0x40, 0x31, 
+	0x63, 0xaa, 0xde, 0x3d, 0x0f, 0x1c, 0xdf, 0x3e, 0x77, 0xc1, 0x7c, 0x11, 0x84, 0x82, 0x4c, 0xe9, 
+	0x23, 0x83, 0x1b, 0xc1, 0x1c, 0xda, 0x86, 0xcc, 0x67, 0x7a, 0xd2, 0x53, 0x9d, 0x41, 0x74, 0x2d, 
+	0x9b, 0x07, 0x38, 0xee, 0x43, 0x4b, 0xbd, 0xfb, 0x96, 0xd5, 0xbe, 0x3b, 0x7c, 0x02, 0x13, 0xfa, 
+	0x73, 0x1a, 0x20, 0x1a, 0x29, 0xb6, 0x15, 0x9d, 0x74, 0x1e, 0x59, 0xda, 0xd1, 0x35, 0xbd, 0x67, 
+	0x54, 0x92, 0x26, 0x05, 0x3f, 0xe7, 0x72, 0x69, 0xc4, 0x9b, 0x21, 0x4c, 0xd9, 0x84, 0x51, 0x0e, 
+	0x69, 0x47, 0x0e, 0x99, 0x87, 0x95, 0x13, 0x74, 0xbf, 0xa6, 0xd5, 0xee, 0xb6, 0x7b, 0xed, 0xbb, 
+	0xe7, 0xbb, 0x07, 0x11, 0x87, 0xb7, 0xe5, 0x28, 0xb0, 0xd2, 0x36, 0xd7, 0xfc, 0x7f, 0xf5, 0xc3, 
+	0x61, 0x0f, 0x0e, 0xe6, 0xb0, 0x51, 0x43, 0x33, 0xdc, 0x17, 0x9a, 0xb1, 0x2c, 0x33, 0xc3, 0x5e, 
+	0x43, 0xce, 0x33, 0x7a, 0xf0, 0x3a, 0xf2, 0xca, 0x70, 0x3d, 0xfc, 0x5d, 0xa9, 0xaf, 0x2d, 0x5d, 
+	0x16, 0x89, 0x27, 0x68, 0x1e, 0x29, 0xb8, 0xff, 0xf9, 0x04, 0x40, 0xed, 0x7f, 0x15, 0x50, 0x5f, 
+	0x3e, 0xc7, 0x01, 0x6d, 0xad, 0x56, 0x2f, 0x6d, 0x4d, 0xe6, 0xf8, 0xa3, 0xda, 0x0f, 0xd5, 0x9f, 
+	0x0e, 0x87, 0x6a, 0x98, 0x07, 0x55, 0xdb, 0x9a, 0xe6, 0xce, 0x1d, 0xbe, 0x8f, 0xbc, 0xcf, 0xa8, 
+	0x50, 0xc3, 0xd2, 0x67, 0xa0, 0x42, 0x4f, 0x08, 0xcb, 0xa6, 0xf5, 0x7e, 0xf0, 0xbc, 0x85, 0x67, 
+	0x49, 0xca, 0xb3, 0xb6, 0xa7, 0xf4, 0x3c, 0x1b, 0xed, 0x39, 0x15, 0xdb, 0xb2, 0x73, 0x0f, 0x42, 
+	0x1a, 0xc9, 0x69, 0x30, 0xf9, 0xbc, 0x24, 0x67, 0x4c, 0x4b, 0x94, 0x9a, 0xd4, 0x1b, 0xf1, 0xd3, 
+	0x0c, 0xdb, 0xfb, 0x87, 0x82, 0xd3, 0x08, 0xcc, 0xd2, 0x37, 0xfd, 0x7c, 0xa5, 0xc0, 0x4c, 0x90, 
+	0x33, 0x8e, 0xcf, 0x8b, 0xb2, 0xd3, 0xb6, 0x9c, 0x91, 0xf5, 0x58, 0x30, 0x68, 0xb7, 0x91, 0x2c, 
+	0xe0, 0xa6, 0x2d, 0xe8, 0x99, 0x23, 0x9c, 0x77, 0x8e, 0xf6, 0xac, 0x1a, 0x84, 0x1a, 0x84, 0x96, 
+	0x8d, 0x50, 0x15, 0x65, 0x3c, 0x5a, 0x65, 0x88, 0xfd, 0x34, 0x0a, 0x3a, 0x3e, 0x0e, 0xe1, 0x87, 
+	0x21, 0xff, 0x17, 0x6d, 0xe7, 0x79, 0x41, 0xec, 0x79, 0x18, 0xe2, 0xd8, 0x1d, 0x3d, 0x78, 0x63, 
+	0x2d, 0x42, 0xfc, 0x8e, 0xa8, 0xa3, 0x13, 0xba, 0xa0, 0x4b, 0x68, 0x66, 0xa6, 0x43, 0x94, 0x73, 
+	0x7f, 0x36, 0x97, 0xab, 0x3d, 0x45, 0x53, 0x2a, 0x88, 0x3d, 0xa5, 0xfe, 0x84, 0x39, 0x64, 0xb4, 
+	0x24, 0x9e, 0x5e, 0x07, 0xa1, 0xbe, 0x0e, 0x5f, 0x0e, 0x9c, 0x06, 0x74, 0x73, 0x49, 0x16, 0x60, 
+	0xe6, 0x52, 0x81, 0x3b, 0x8a, 0x70, 0x75, 0xbc, 0x16, 0x07, 0xcc, 0x10, 0x98, 0x80, 0xef, 0x10, 
+	0xc3, 0x00, 0xe8, 0xba, 0x9e, 0xca, 0xd1, 0xe3, 0xfe, 0x62, 0x70, 0x73, 0x9c, 0x34, 0x68, 0x5a, 
+	0xad, 0xb7, 0xd6, 0xa7, 0xff, 0xfa, 0x75, 0xf0, 0x72, 0x56, 0xc1, 0xcb, 0x7e, 0xc2, 0xb1, 0x08, 
+	0xdc, 0xdb, 0x54, 0xe7, 0x87, 0x50, 0xbd, 0xa9, 0xfb, 0x87, 0xa1, 0xba, 0xa1, 0xfa, 0xd9, 0x53, 
+	0x3d, 0x9f, 0xd8, 0x31, 0xe5, 0x9f, 0x1d, 0xb1, 0x9f, 0xef, 0xc6, 0xd0, 0xab, 0xff, 0x31, 0x62, 
+	0xdf, 0xfc, 0x3a, 0x62, 0xf3, 0x2c, 0x62, 0xab, 0x9d, 0x71, 0xbb, 0x5e, 0x0f, 0xb4, 0x9a, 0xc5, 
+	0x30, 0xef, 0x06, 0x32, 0x98, 0x3e, 0x87, 0x9d, 0xa2, 0xb8, 0xaf, 0x68, 0x15, 0xc3, 0x63, 0x73, 
+	0x83, 0x67, 0x02, 0xd6, 0xfa, 0xf1, 0x47, 0xd7, 0xcd, 0xdc, 0x35, 0x44, 0x63, 0xd2, 0x47, 0xfb, 
+	0x94, 0x9c, 0xac, 0xfd, 0x42, 0xb8, 0x71, 0x7f, 0x0b, 0xd0, 0x90, 0xc9, 0x03, 0x87, 0xdb, 0x31, 
+	0xa9, 0x4f, 0xc4, 0xe7, 0xe1, 0xfb, 0x76, 0xbf, 0x77, 0x06, 0xaf, 0x0c, 0xaa, 0x9f, 0xd1, 0x2b, 
+	0x83, 0x7e, 0xcd, 0x1b, 0x83, 0x5e, 0xe6, 0x13, 0x32, 0x07, 0x82, 0x69, 0x4a, 0x3a, 0xa3, 0x5d, 
+	0x80, 0x8c, 0x35, 0xad, 0xd1, 0xb2, 0x06, 0x92, 0x67, 0xa3, 0x65, 0x33, 0xd9, 0x98, 0x25, 0x64, 
+	0xa7, 0x90, 0x06, 0x38, 0x4c, 0x00, 0xf0, 0xd9, 0xc8, 0x59, 0x8d, 0xcb, 0xd6, 0xdb, 0xe7, 0xbc, 
+	0x1c, 0x77, 0xc6, 0x6a, 0xf6, 0xb2, 0xf4, 0xe8, 0xf1, 0x05, 0x30, 0xde, 0x98, 0x80, 0xf0, 0x59, 
+	0x38, 0x59, 0xee, 0xd2, 0xb3, 0x6d, 0x65, 0x65, 0xe4, 0xac, 0x21, 0xf5, 0x99, 0xca, 0xd9, 0x8d, 
+	0x5d, 0xf7, 0xda, 0xa3, 0x95, 0x5c, 0x05, 0x7e, 0x86, 0x18, 0xbc, 0x4e, 0xab, 0xd8, 0x4c, 0xcc, 
+	0x9e, 0x6a, 0xae, 0xe0, 0xae, 0xdd, 0x7f, 0xf7, 0xb3, 0x11, 0xa3, 0x4f, 0x21, 0x46, 0xf3, 0x10, 
+	0xb6, 0x86, 0x9c, 0x7e, 0xd0, 0x62, 0x17, 0xe4, 0xba, 0xfa, 0x71, 0x0c, 0x03, 0x39, 0x03, 0xb9, 
+	0xf3, 0x84, 0x5c, 0xf4, 0xbc, 0x10, 0x92, 0x6d, 0xec, 0xd2, 0x49, 0xac, 0x4c, 0x57, 0x43, 0x6e, 
+	0x18, 0x54, 0xad, 0x93, 0x40, 0x9b, 0x05, 0x2a, 0x5d, 0xc9, 0x55, 0xf6, 0x88, 0x4f, 0x22, 0xe9, 
+	0x1a, 0xc8, 0x88, 0xd9, 0x81, 0x07, 0x08, 0xc4, 0xf0, 0x45, 0x8f, 0x8c, 0xa8, 0xe7, 0xef, 0xf5, 
+	0xe7, 0x32, 0x86, 0xed, 0xdd, 0x4e, 0xaf, 0x33, 0x1c, 0x18, 0x54, 0x3e, 0x05, 0x2a, 0xf3, 0x40, 
+	0xb8, 0x46, 0x25, 0x46, 0x5d, 0xd8, 0x05, 0xca, 0x16, 0x46, 0x66, 0x30, 0x98, 0x34, 0x98, 0x3c, 
+	0x53, 0x2d, 0xb8, 0x0e, 0x1c, 0x82, 0xa8, 0x8c, 0x1e, 0x6c, 0x4f, 0xa2, 0xf2, 0xe9, 0x31, 0xd7, 
+	0xfa, 0x38, 0x34, 0x7a, 0x70, 0xaf, 0x40, 0x75, 0xbf, 0x16, 0x72, 0xd9, 0x08, 0x4b, 0x21, 0x2e, 
+	0x7f, 0x6a, 0x52, 0xd1, 0xcd, 0xcc, 0x4b, 0x1a, 0xc2, 0x9d, 0xdd, 0xbc, 0x64, 0x01, 0xd8, 0xb2, 
+	0x66, 0x27, 0x37, 0xcc, 0x9f, 0xcd, 0xa4, 0xa4, 0xa2, 0xe4, 0x99, 0xcd, 0x49, 0x96, 0x15, 0xc1, 
+	0xf8, 0x04, 0x7b, 0x5c, 0x6b, 0x57, 0x25, 0x07, 0x31, 0xce, 0x87, 0xf0, 0x9a, 0xcf, 0xd0, 0x36, 
+	0x16, 0x07, 0xa8, 0x84, 0x70, 0xa6, 0x96, 0x97, 0xfb, 0xc8, 0x40, 0x8f, 0xfb, 0x2a, 0xdc, 0x6a, 
+	0x27, 0x32, 0x35, 0x62, 0xd4, 0xa0, 0xba, 0x74, 0x54, 0x4f, 0x83, 0x50, 0xaa, 0x15, 0x21, 0x0e, 
+	0x50, 0x1e, 0x31, 0xb9, 0x60, 0x08, 0xe3, 0x45, 0x40, 0x22, 0xc7, 0x12, 0x02, 0xbc, 0x47, 0xc4, 
+	0x0f, 0x5a, 0x09, 0x44, 0x77, 0x72, 0x05, 0x1e, 0xe1, 0xad, 0xe3, 0xdf, 0xa9, 0xb1, 0x3b, 0x0c, 
+	0xd5, 0xe9, 0x5c, 0x00, 0xef, 0x09, 0x78, 0xf8, 0x9c, 0xc5, 0x10, 0xaf, 0x90, 0x68, 0xb2, 0x2a, 
+	0x0e, 0xa9, 0xa7, 0x82, 0x26, 0xab, 0xc2, 0xca, 0x2e, 0xa6, 0x3d, 0xf9, 0x65, 0xce, 0xed, 0xcf, 
+	0xee, 0xf2, 0x44, 0xb4, 0xee, 0x75, 0xee, 0xac, 0xce, 0xdd, 0xb0, 0xdd, 0xff, 0x74, 0xd3, 0xb5, 
+	0x7a, 0x83, 0x92, 0x65, 0xed, 0xd9, 0x0c, 0xde, 0x77, 0x09, 0x5b, 0x4f, 0x7c, 0x9d, 0xb0, 0xcd, 
+	0x05, 0x63, 0x63, 0x3c, 0x2e, 0x08, 0xae, 0xd4, 0x67, 0x13, 0xf0, 0x8b, 0x5b, 0xc6, 0x9c, 0x8b, 
+	0xdb, 0x20, 0x5c, 0xd0, 0xd0, 0x31, 0x11, 0x96, 0x0c, 0x2a, 0xcb, 0x46, 0xe5, 0x8d, 0x0a, 0x89, 
+	0xa4, 0x83, 0xbd, 0xfb, 0xd0, 0x2e, 0x71, 0x18, 0xe6, 0xf8, 0x89, 0xfd, 0x10, 0xbd, 0x56, 0x05, 
+	0x34, 0x7a, 0x4c, 0xef, 0x18, 0x05, 0xe5, 0x2a, 0x75, 0x48, 0xa4, 0x00, 0x1f, 0xf5, 0x5f, 0x87, 
+	0x6a, 0xc7, 0x00, 0xef, 0x58, 0x0d, 0xca, 0x54, 0xcc, 0x07, 0x50, 0x5d, 0x00, 0x1d, 0x5f, 0x6c, 
+	0x06, 0x44, 0xda, 0x0c, 0x40, 0x8a, 0xb2, 0x38, 0xe4, 0x00, 0x5a, 0x3d, 0x77, 0x1a, 0x27, 0x47, 
+	0x15, 0xea, 0xe8, 0x4b, 0x68, 0x83, 0x71, 0xf3, 0x02, 0x38, 0xb6, 0x2d, 0xa3, 0x53, 0xf3, 0x28, 
+	0x5e, 0x53, 0x78, 0x5c, 0xac, 0xde, 0xde, 0x7e, 0x65, 0x6c, 0xa4, 0x54, 0xef, 0x47, 0x1a, 0x70, 
+	0xc7, 0x1a, 0xf3, 0x50, 0xe4, 0x46, 0xf8, 0xb8, 0xc5, 0xcc, 0xf8, 0x35, 0x10, 0xd0, 0x72, 0xa4, 
+	0xd3, 0x32, 0xfa, 0xc9, 0x40, 0xa1, 0xfc, 0x77, 0xe6, 0x2c, 0x50, 0x3d, 0x41, 0xbf, 0x05, 0x87, 
+	0x8c, 0x55, 0xd2, 0x76, 0x2f, 0x5f, 0x4c, 0x03, 0x91, 0x86, 0x02, 0x28, 0xa6, 0x39, 0xc6, 0xb8, 
+	0xc4, 0x08, 0x96, 0x63, 0xbc, 0xd7, 0x8d, 0xf5, 0xbd, 0xee, 0xe8, 0x7d, 0xb4, 0xd3, 0xb2, 0x6e, 
+	0x3b, 0xfd, 0xc1, 0xb0, 0x44, 0xb5, 0x73, 0x79, 0xf5, 0xea, 0x79, 0xcc, 0xe1, 0x15, 0xe8, 0x9c, 
+	0xfa, 0x96, 0xce, 0xc9, 0xc4, 0x56, 0x04, 0x33, 0x9c, 0x95, 0xc8, 0x5d, 0xb7, 0xa5, 0x06, 0x65, 
+	0x06, 0x65, 0x67, 0x17, 0x59, 0x23, 0xda, 0x1b, 0x78, 0xee, 0x2c, 0xeb, 0xde, 0x18, 0x94, 0xb9, 
+	0xab, 0x33, 0x39, 0x32, 0xcc, 0x92, 0xd8, 0x42, 0x96, 0x61, 0x2c, 0xfc, 0x5c, 0x51, 0xb6, 0x31, 
+	0x44, 0x23, 0xef, 0xc0, 0xd0, 0xac, 0x3e, 0x18, 0x8e, 0x95, 0xcd, 0xb1, 0xd5, 0x5b, 0xae, 0x56, 
+	0x21, 0x2a, 0x71, 0x84, 0x05, 0x70, 0x4a, 0x0c, 0xd0, 0xf4, 0x5a, 0x84, 0x1a, 0x98, 0xe1, 0xde, 
+	0x93, 0x91, 0x08, 0xc2, 0x91, 0x5e, 0x6b, 0x48, 0xf0, 0x8b, 0x7c, 0xd2, 0xb3, 0x53, 0x23, 0xe6, 
+	0x06, 0x0b, 0x52, 0xaf, 0xd5, 0xc8, 0x6f, 0x89, 0xcb, 0x30, 0x1c, 0xad, 0x08, 0x3c, 0x16, 0x9d, 
+	0xeb, 0x2a, 0x08, 0x79, 0x6a, 0x3c, 0x76, 0x74, 0xfa, 0xbd, 0xbb, 0xe9, 0x1c, 0xf6, 0xae, 0xc4, 
+	0xda, 0x19, 0xad, 0x34, 0x5c, 0x96, 0xb3, 0xd2, 0x70, 0xb5, 0xe7, 0x4a, 0xc3, 0x0f, 0x25, 0x2f, 
+	0x34, 0x6c, 0xa1, 0x16, 0xe1, 0x8b, 0xb3, 0xb2, 0xc1, 0x5c, 0x16, 0x2c, 0x2a, 0x0c, 0xf4, 0x64, 
+	0xec, 0x50, 0x1b, 0x1a, 0x1d, 0x69, 0xf8, 0x5b, 0xfa, 0x92, 0x82, 0xf6, 0x48, 0x8f, 0x09, 0x01, 
+	0x38, 0x10, 0x24, 0x70, 0x1d, 0x4d, 0xda, 0x68, 0xf1, 0x16, 0x37, 0x37, 0xfb, 0x81, 0x7c, 0x22, 
+	0xc1, 0x38, 0xec, 0xf4, 0xda, 0xf7, 0x1f, 0x87, 0xe5, 0x4e, 0xf6, 0x5f, 0xed, 0x9c, 0xeb, 0xaf, 
+	0x3f, 0xdd, 0x5c, 0xff, 0x91, 0x27, 0xfb, 0x73, 0x28, 0xd5, 0x80, 0x8e, 0x36, 0xb6, 0x30, 0xb2, 
+	0x29, 0xb3, 0x1c, 0x06, 0xe7, 0x5b, 0xc0, 0x30, 0x18, 0x0a, 0x8f, 0xf9, 0x84, 0x0c, 0xd0, 0x98, 
+	0xb4, 0xd0, 0xd8, 0x70, 0xcc, 0x70, 0xac, 0xf4, 0x10, 0x6a, 0xb8, 0x22, 0x8a, 0xaa, 0xce, 0x56, 
+	0xee, 0x39, 0x47, 0xe1, 0x08, 0xaa, 0x32, 0x9a, 0x5e, 0x17, 0x92, 0x2e, 0xc9, 0xdc, 0x5f, 0xed, 
+	0x51, 0xd1, 0xf3, 0xf5, 0x7a, 0x21, 0x74, 0x11, 0x82, 0xd3, 0x31, 0xb5, 0x30, 0x30, 0x86, 0x01, 
+	0xd5, 0xb4, 0x42, 0xee, 0xd8, 0x22, 0x59, 0x8d, 0xc6, 0x20, 0xbe, 0x65, 0x81, 0x43, 0x69, 0xee, 
+	0x79, 0x00, 0x12, 0x2a, 0x99, 0xbb, 0x24, 0x8c, 0xe3, 0xd3, 0x4f, 0x64, 0x41, 0x97, 0x2f, 0x40, 
+	0x63, 0xaa, 0xba, 0x70, 0x1f, 0x0b, 0x25, 0xa3, 0x39, 0xce, 0x80, 0x83, 0xa8, 0xd5, 0xc7, 0xc4, 
+	0x81, 0x38, 0xc7, 0xdf, 0x78, 0xee, 0xeb, 0x7d, 0x2e, 0x58, 0xd6, 0x77, 0x04, 0xbe, 0x20, 0x01, 
+	0x4e, 0x31, 0xf0, 0x99, 0x3e, 0xb8, 0xaa, 0x41, 0xed, 0x93, 0x56, 0x1f, 0x04, 0xc1, 0x9d, 0xd5, 
+	0xcb, 0xd4, 0x45, 0xc5, 0x67, 0x8a, 0x25, 0x45, 0xa0, 0xdf, 0x10, 0xab, 0xaf, 0x25, 0x64, 0x36, 
+	0x03, 0xbd, 0x0c, 0x4a, 0xf8, 0x26, 0x5d, 0x26, 0xd2, 0xce, 0xc8, 0x72, 0xd5, 0xcf, 0x1d, 0xb2, 
+	0x64, 0x2a, 0xc5, 0x0d, 0x84, 0x5a, 0xd1, 0xd0, 0x1a, 0x1b, 0xbe, 0x89, 0x23, 0x2f, 0xe7, 0xe2, 
+	0x5f, 0x83, 0xe1, 0x7d, 0xbf, 0x6d, 0xb5, 0xda, 0xdd, 0x9b, 0x9f, 0xcb, 0x85, 0xfb, 0xef, 0x9f, 
+	0x72, 0x25, 0xb7, 0x56, 0xdb, 0x35, 0x29, 0x50, 0x3b, 0x36, 0xe0, 0x73, 0x41, 0xde, 0xa8, 0x3e, 
+	0xd0, 0x90, 0xae, 0xbe, 0x0d, 0x58, 0x78, 0x1f, 0xc2, 0xad, 0x7e, 0xa3, 0xac, 0x80, 0x6f, 0xeb, 
+	0xa9, 0x23, 0x8b, 0x3b, 0x70, 0xe0, 0x2d, 0x03, 0xdc, 0xa9, 0x65, 0xc5, 0x4b, 0xc6, 0xf3, 0xd5, 
+	0x5e, 0xef, 0x2c, 0x53, 0xb4, 0x1a, 0xd1, 0xb9, 0xa3, 0x6c, 0xb2, 0x0c, 0xf0, 0xb9, 0x56, 0xdc, 
+	0x33, 0x8e, 0x75, 0x85, 0xb2, 0xd0, 0x82, 0xf9, 0x99, 0x67, 0xa3, 0xde, 0x57, 0xee, 0xa2, 0xe3, 
+	0x16, 0xd7, 0x93, 0xb2, 0xcb, 0xa9, 0x6d, 0xfd, 0x0a, 0xf4, 0xdc, 0x8a, 0x12, 0x6f, 0x49, 0xdf, 
+	0x69, 0xb0, 0x7a, 0x8d, 0x7a, 0xae, 0xe5, 0xea, 0x1d, 0xc7, 0xb9, 0x16, 0xea, 0x35, 0x9d, 0x85, 
+	0xb9, 0x3c, 0x37, 0x37, 0x64, 0x22, 0xb3, 0x55, 0xf5, 0xcb, 0x4e, 0x72, 0xb3, 0x56, 0x91, 0xfd, 
+	0x73, 0x2d, 0xc2, 0x9d, 0x16, 0x18, 0xa1, 0xb5, 0xa0, 0x78, 0x76, 0xe6, 0x76, 0x50, 0xab, 0xbd, 
+	0xac, 0x78, 0xa1, 0x55, 0x22, 0x98, 0xc0, 0x1e, 0x96, 0xce, 0xa8, 0xf8, 0xa0, 0x89, 0xc7, 0xc1, 
+	0x0a, 0x4d, 0x93, 0x8f, 0x43, 0x14, 0x9a, 0x6e, 0x6e, 0x2a, 0xde, 0x6d, 0xb8, 0xe3, 0x14, 0x53, 
+	0x1b, 0x39, 0xb2, 0x6c, 0xd5, 0x9a, 0x6e, 0x4e, 0x46, 0xbc, 0x4a, 0x92, 0x9f, 0x8d, 0xf3, 0x8e, 
+	0x39, 0xb9, 0x13, 0x35, 0xaf, 0x98, 0x99, 0xb5, 0x16, 0x9e, 0x99, 0x67, 0xbf, 0x0d, 0xae, 0x0d, 
+	0xb3, 0x46, 0x35, 0x09, 0xac, 0xc6, 0xbb, 0x30, 0x98, 0xcf, 0xe0, 0x56, 0xba, 0x51, 0xcb, 0x04, 
+	0x93, 0x52, 0x90, 0x54, 0x69, 0x4a, 0x99, 0xbe, 0x53, 0xb3, 0x49, 0x6e, 0xa3, 0xba, 0x4e, 0x4a, 
+	0x03, 0x77, 0x94, 0x51, 0x43, 0x22, 0x6b, 0xe3, 0x39, 0x3e, 0x84, 0xf2, 0x28, 0xa7, 0xaa, 0x44, 
+	0x99, 0x4d, 0xea, 0x6e, 0x19, 0xcd, 0x30, 0x73, 0x8b, 0x83, 0x3a, 0x75, 0xaf, 0x12, 0x8a, 0x64, 
+	0xbb, 0xed, 0xb3, 0x39, 0x79, 0x70, 0xb9, 0xa2, 0xa3, 0xad, 0x1b, 0x24, 0xeb, 0x8a, 0xd7, 0xb9, 
+	0x5f, 0xd9, 0xea, 0xcd, 0x9b, 0xbb, 0x63, 0x36, 0x79, 0xea, 0x3e, 0xb7, 0xbb, 0x25, 0x72, 0xef, 
+	0x7b, 0xbb, 0x8b, 0xa6, 0xee, 0x83, 0xe5, 0xb4, 0x1f, 0xbe, 0x5f, 0xf4, 0x98, 0x0d, 0xb8, 0x75, 
+	0xaf, 0xdc, 0xdd, 0x0e, 0xa9, 0x7b, 0xe7, 0x81, 0x05, 0x36, 0xee, 0xa5, 0x7b, 0x96, 0xdc, 0xb8, 
+	0xb7, 0xee, 0x59, 0x22, 0xba, 0xd7, 0x1e, 0x60, 0xcd, 0xcb, 0xfa, 0x3d, 0x53, 0xaf, 0x34, 0x3c, 
+	0xf2, 0x0f, 0xab, 0x84, 0xc3, 0x1e, 0x18, 0x8a, 0x85, 0xc4, 0x9e, 0xa6, 0x1b, 0xc2, 0x62, 0xcf, 
+	0x12, 0xe1, 0xc1, 0x25, 0xb4, 0xf0, 0xd8, 0xbb, 0xfa, 0x02, 0xe3, 0xd3, 0x13, 0x8d, 0xe8, 0xd9, 
+	0xb7, 0xa3, 0x82, 0x2d, 0x43, 0x42, 0xed, 0x87, 0xa8, 0xb4, 0xa4, 0x3a, 0xa0, 0x54, 0x4a, 0x62, 
+	0x1d, 0x5c, 0x12, 0xf5, 0xcc, 0x21, 0x27, 0x99, 0x92, 0x60, 0x07, 0x14, 0x4d, 0x4b, 0xb2, 0x03, 
+	0x8a, 0x26, 0x25, 0xda, 0xa1, 0x05, 0x0f, 0xbc, 0xc4, 0x2d, 0x09, 0x57, 0x8e, 0x8f, 0x26, 0x77, 
+	0xf5, 0x1e, 0xcf, 0x4b, 0x23, 0xf9, 0xb9, 0xbb, 0x41, 0x12, 0x72, 0x74, 0x5f, 0x73, 0x2d, 0x4f, 
+	0xf7, 0xb2, 0xd6, 0x72, 0x75, 0x2f, 0xd3, 0x4d, 0xf9, 0x5a, 0xce, 0xaf, 0x81, 0x53, 0xae, 0x2a, 
+	0xdc, 0xfa, 0x51, 0x75, 0xd0, 0xb6, 0xea, 0x3e, 0xda, 0xd5, 0x45, 0x62, 0x3b, 0x96, 0xf0, 0x6b, 
+	0xcd, 0xde, 0xa8, 0xea, 0x59, 0xe4, 0xb8, 0xa2, 0xff, 0x00, 0xd9, 0x2d, 0x22, 0x36, 
 };
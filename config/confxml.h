@@ -8,7 +8,7 @@
 #include <stdbool.h>
 
 // Constants
-#define DATA_MAIN_CONFIG_T__SIZE		1670
+#define DATA_MAIN_CONFIG_T__SIZE		4062
 
 // Variables
 extern uint8_t data_main_config_t_[];
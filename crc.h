@@ -22,10 +22,20 @@
 
 #include <stdint.h>
 
+// CRC16 implementations, selectable at build time with CRC16_IMPL
+#define CRC16_IMPL_TABLE		0 // One table lookup per byte
+#define CRC16_IMPL_SLICE4		1 // Four bytes per iteration, 1.5 kB of extra tables
+#define CRC16_IMPL_HW			2 // CRC peripheral, shared through a mutex
+
+#ifndef CRC16_IMPL
+#define CRC16_IMPL				CRC16_IMPL_SLICE4
+#endif
+
 /*
  * Functions
  */
 unsigned short crc16(unsigned char *buf, unsigned int len);
+unsigned short crc16_update(unsigned short crc, const unsigned char *buf, unsigned int len);
 uint32_t crc32(uint32_t *buf, uint32_t len);
 void crc32_reset(void);
 
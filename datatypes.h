@@ -47,6 +47,11 @@ typedef enum {
 	CAN_BAUD_75K
 } CAN_BAUD;
 
+typedef enum {
+	LOAD_CTRL_MODE_LINEAR = 0,
+	LOAD_CTRL_MODE_PI
+} LOAD_CTRL_MODE;
+
 typedef struct {
 	// ID if this BMS (e.g. on the CAN-bus)
 	uint8_t controller_id;
@@ -72,8 +77,70 @@ typedef struct {
 	float load_volt_max;
 	// Load at maximum voltage
 	float load_volt_max_fraction;
+
+	// How the load is derived from the input voltage
+	LOAD_CTRL_MODE load_ctrl_mode;
+	// Bus voltage regulator gains used in PI mode
+	float load_pi_kp;
+	float load_pi_ki;
+
+	// Resistance of the load
+	float load_res;
+
+	// Lumped thermal model of the resistor element and heatsink, used for
+	// derating on the estimated element temperature.
+	bool tmod_en;
+	// Heat capacity of the element in J/K
+	float tmod_c_element;
+	// Thermal resistance from the element to the heatsink in K/W
+	float tmod_r_element;
+	// Heat capacity of the heatsink in J/K
+	float tmod_c_hs;
+	// Thermal resistance from the heatsink to ambient in K/W
+	float tmod_r_hs;
+
+	// CAN status frames. The electrical frame is sent at
+	// send_can_status_rate_hz, the other frames at their own rates. A rate
+	// of 0 disables periodic sending of that frame. A frame is also sent
+	// when its value has moved more than the deadband since it was last
+	// sent, but not more often than can_stat_min_interval_ms.
+	float can_stat_elec_db_v;
+	float can_stat_elec_db_i;
+	uint16_t can_stat_therm_rate_hz;
+	float can_stat_therm_db;
+	uint16_t can_stat_energy_rate_hz;
+	uint16_t can_stat_limits_rate_hz;
+	uint16_t can_stat_duty_rate_hz;
+	float can_stat_duty_db;
+	uint16_t can_stat_min_interval_ms;
+
+	// Feed-forward from the regenerative input current reported in
+	// CAN_PACKET_STATUS_4 by the controllers from ff_id_first to ff_id_last
+	bool ff_en;
+	uint8_t ff_id_first;
+	uint8_t ff_id_last;
+	// Fraction of the regenerative power to absorb
+	float ff_gain;
+	// Ignore status messages older than this
+	uint16_t ff_timeout_ms;
+
+	// Time the configuration has to be unchanged before it is written to flash
+	uint16_t conf_store_delay_ms;
 } main_config_t;
 
+#define ENERGY_DUTY_BINS		10
+
+typedef struct {
+	// Dissipated energy and charge
+	double wh;
+	double ah;
+	// Highest input power seen
+	float peak_power;
+	// Seconds spent in each duty cycle range, bin i covering
+	// i / ENERGY_DUTY_BINS to (i + 1) / ENERGY_DUTY_BINS
+	float duty_time[ENERGY_DUTY_BINS];
+} energy_stats;
+
 // Backup data that is retained between boots and firmware updates. When adding new
 // entries, put them at the end.
 typedef struct {
@@ -99,6 +166,11 @@ typedef struct {
 	uint32_t hw_config_init_flag;
 	uint8_t hw_config[128];
 
+	// Lifetime energy accounting. Kept ahead of the config, so that changes to
+	// the config struct don't move it and reset the totals.
+	uint32_t energy_init_flag;
+	energy_stats energy;
+
 	// Main configuration structure
 	uint32_t config_init_flag;
 	main_config_t config;
@@ -160,6 +232,54 @@ typedef struct {
 	bool is_charge_allowed;
 } bms_soc_soh_temp_stat;
 
+#define CAN_TX_LAT_BINS			8
+#define CAN_TX_LAT_BIN_LIMITS_US	{100, 250, 500, 1000, 2500, 5000, 10000, 0xFFFFFFFF}
+#define CAN_RX_TYPES				64 // Packet types counted separately, the last one counts the rest
+
+// CAN transmit priority classes, lower values are sent first
+typedef enum {
+	CAN_TX_PRIO_HIGH = 0, // Control and status
+	CAN_TX_PRIO_NORMAL, // Replies and other single frames
+	CAN_TX_PRIO_BULK, // Buffer transfers, short ones included to keep their order
+	CAN_TX_PRIO_NUM
+} CAN_TX_PRIO;
+
+typedef struct {
+	// Frames received into the RX queue
+	uint32_t rx_frames;
+	// Frames dropped because the RX queue was full
+	uint32_t rx_dropped;
+	// Frames lost because the hardware FIFO overflowed
+	uint32_t rx_overruns;
+	// Frames handed to a TX mailbox
+	uint32_t tx_frames;
+	// Frames dropped because their TX queue was full
+	uint32_t tx_dropped[CAN_TX_PRIO_NUM];
+	// Time from queueing a frame until it got a mailbox
+	uint32_t tx_latency_max_us[CAN_TX_PRIO_NUM];
+	uint32_t tx_latency_avg_us[CAN_TX_PRIO_NUM];
+	// Bulk frames that had to wait for room in their queue
+	uint32_t tx_bulk_stalls;
+	// Transitions into error warning, error passive and bus off
+	uint32_t err_warning;
+	uint32_t err_passive;
+	uint32_t err_bus_off;
+	// Frames with a bit, stuff, form or CRC error
+	uint32_t err_framing;
+	// Current transmit and receive error counters
+	uint8_t tec;
+	uint8_t rec;
+	// Highest number of frames waiting in the queues
+	uint32_t rx_queue_max;
+	uint32_t tx_queue_max[CAN_TX_PRIO_NUM];
+	// Over the last second
+	float rx_rate;
+	float tx_rate;
+	float bus_load;
+	// TX latency of all classes, see CAN_TX_LAT_BIN_LIMITS_US
+	uint32_t tx_latency_hist[CAN_TX_LAT_BINS];
+} can_stats;
+
 typedef struct {
 	int id;
 	systime_t rx_time;
@@ -171,6 +291,21 @@ typedef struct {
 	bool is_dsc_on;
 } psw_status;
 
+// All status messages received from one node on the CAN-bus
+typedef struct {
+	int id;
+	systime_t rx_time;
+	int hw_type; // HW_TYPE from the last pong, -1 if the node never answered a ping
+	systime_t pong_time;
+	can_status_msg status;
+	can_status_msg_2 status_2;
+	can_status_msg_3 status_3;
+	can_status_msg_4 status_4;
+	can_status_msg_5 status_5;
+	bms_soc_soh_temp_stat bms;
+	psw_status psw;
+} can_node_status;
+
 typedef enum {
 	FAULT_CODE_NONE = 0,
 	FAULT_CODE_CHARGE_OVERCURRENT,
@@ -250,6 +385,17 @@ typedef enum {
 	CAN_PACKET_UPDATE_PID_POS_OFFSET,
 	CAN_PACKET_POLL_ROTOR_POS,
 	CAN_PACKET_BMS_BOOT,
+
+	// Vendor range. IDs from 200 are only used by this firmware and get fixed
+	// values, so that IDs added upstream after CAN_PACKET_BMS_BOOT cannot
+	// collide with them. They are counted in the last entry of the per-type
+	// receive statistics.
+	CAN_PACKET_RES_ENERGY = 200,
+	CAN_PACKET_BULK_START = 201,
+	CAN_PACKET_BULK_DATA = 202,
+	CAN_PACKET_BULK_ACK = 203,
+	CAN_PACKET_RES_LIMITS = 204,
+	CAN_PACKET_RES_DUTY = 205,
 	CAN_PACKET_MAKE_ENUM_32_BITS = 0xFFFFFFFF,
 } CAN_PACKET_ID;
 
@@ -398,6 +544,16 @@ typedef enum {
 	COMM_GET_EXT_HUM_TMP,
 	COMM_GET_STATS,
 	COMM_RESET_STATS,
+
+	// Vendor range. IDs from 200 are only used by this firmware and get fixed
+	// values, so that IDs added upstream after COMM_RESET_STATS cannot collide
+	// with them.
+	COMM_RES_TELEMETRY = 200,
+	COMM_RES_CAPTURE = 201,
+	COMM_RES_CAN_STATS = 202,
+	COMM_RES_CONF_STORE = 203,
+	COMM_RES_ENERGY = 204,
+	COMM_RES_ENERGY_RESET = 205,
 } COMM_PACKET_ID;
 
 #endif /* DATATYPES_H_ */
@@ -0,0 +1,198 @@
+/*
+	Copyright 2021 - 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC Braking Resistor firmware.
+
+	The VESC Braking Resistor firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC Braking Resistor firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "ch.h"
+#include "hal.h"
+#include "energy.h"
+#include "main.h"
+#include "flash_helper.h"
+#include "terminal.h"
+#include "commands.h"
+#include "utils.h"
+#include <string.h>
+
+// Settings
+#define UPDATE_RATE_HZ			10
+#define STORE_INTERVAL_S		600.0 // Minimum time between flash writes
+#define STORE_MIN_WH			1.0 // Minimum energy since the last flash write
+#define STORE_IDLE_S			5.0 // Time without load before writing to flash
+
+// Threads
+static THD_WORKING_AREA(energy_thread_wa, 512);
+static THD_FUNCTION(energy_thread, arg);
+
+// Private functions
+static void add_stats(volatile energy_stats *stats, float wh, float ah, const float *duty_time);
+static void terminal_energy(int argc, const char **argv);
+
+// Private variables
+static volatile float m_acc_energy = 0.0;
+static volatile float m_acc_charge = 0.0;
+static volatile uint32_t m_acc_duty_cycles[ENERGY_DUTY_BINS];
+static volatile float m_peak_power = 0.0;
+static volatile systime_t m_load_time = 0;
+static volatile energy_stats m_session;
+
+void energy_init(void) {
+	energy_reset_session();
+
+	chThdCreateStatic(energy_thread_wa, sizeof(energy_thread_wa), NORMALPRIO - 1, energy_thread, NULL);
+
+	terminal_register_command_callback(
+			"energy",
+			"Print dissipated energy and time at duty cycle",
+			0,
+			terminal_energy);
+}
+
+/**
+ * Integrate a new sample. Called from the ADC interrupt, so only the
+ * accumulators are updated here. They are moved to the totals by the
+ * thread.
+ *
+ * @param v_in
+ * Input voltage.
+ *
+ * @param i_in
+ * Input current.
+ *
+ * @param duty
+ * Duty cycle applied to the load during the sample.
+ *
+ * @param dt
+ * Time since the previous sample in seconds.
+ */
+void energy_sample(float v_in, float i_in, float duty, float dt) {
+	float power = v_in * i_in;
+
+	m_acc_energy += power * dt;
+	m_acc_charge += i_in * dt;
+
+	if (power > m_peak_power) {
+		m_peak_power = power;
+	}
+
+	int bin = (int)(duty * (float)ENERGY_DUTY_BINS);
+	utils_truncate_number_int(&bin, 0, ENERGY_DUTY_BINS - 1);
+	m_acc_duty_cycles[bin] += (uint32_t)(dt * (float)SystemCoreClock);
+
+	if (duty > 0.001) {
+		m_load_time = chVTGetSystemTimeX();
+	}
+}
+
+void energy_get_session(energy_stats *stats) {
+	chSysLock();
+	*stats = m_session;
+	chSysUnlock();
+}
+
+void energy_get_total(energy_stats *stats) {
+	chSysLock();
+	*stats = backup.energy;
+	chSysUnlock();
+}
+
+void energy_reset_session(void) {
+	chSysLock();
+	memset((void*)&m_session, 0, sizeof(m_session));
+	m_peak_power = 0.0;
+	chSysUnlock();
+}
+
+void energy_reset_total(void) {
+	chSysLock();
+	memset((void*)&backup.energy, 0, sizeof(backup.energy));
+	chSysUnlock();
+}
+
+static void add_stats(volatile energy_stats *stats, float wh, float ah, const float *duty_time) {
+	stats->wh += wh;
+	stats->ah += ah;
+
+	if (m_peak_power > stats->peak_power) {
+		stats->peak_power = m_peak_power;
+	}
+
+	for (int i = 0;i < ENERGY_DUTY_BINS;i++) {
+		stats->duty_time[i] += duty_time[i];
+	}
+}
+
+static THD_FUNCTION(energy_thread, arg) {
+	(void)arg;
+
+	chRegSetThreadName("Energy");
+
+	systime_t store_time = chVTGetSystemTimeX();
+	double store_wh = backup.energy.wh;
+
+	for (;;) {
+		float duty_time[ENERGY_DUTY_BINS];
+
+		chSysLock();
+		float wh = m_acc_energy / 3600.0;
+		float ah = m_acc_charge / 3600.0;
+		m_acc_energy = 0.0;
+		m_acc_charge = 0.0;
+		for (int i = 0;i < ENERGY_DUTY_BINS;i++) {
+			duty_time[i] = (float)m_acc_duty_cycles[i] / (float)SystemCoreClock;
+			m_acc_duty_cycles[i] = 0;
+		}
+
+		add_stats(&m_session, wh, ah, duty_time);
+		add_stats(&backup.energy, wh, ah, duty_time);
+		chSysUnlock();
+
+		// The backup data is retained in RAM across resets, so it only has to
+		// go to flash to survive power loss. Write rarely, and only when the
+		// load has been off for a while as the CPU stalls during the erase.
+		if (UTILS_AGE_S(store_time) > STORE_INTERVAL_S &&
+				(backup.energy.wh - store_wh) > STORE_MIN_WH &&
+				UTILS_AGE_S(m_load_time) > STORE_IDLE_S) {
+			flash_helper_store_backup_data();
+			store_time = chVTGetSystemTimeX();
+			store_wh = backup.energy.wh;
+		}
+
+		chThdSleepMilliseconds(1000 / UPDATE_RATE_HZ);
+	}
+}
+
+static void terminal_energy(int argc, const char **argv) {
+	(void)argc;
+	(void)argv;
+
+	energy_stats session, total;
+	energy_get_session(&session);
+	energy_get_total(&total);
+
+	commands_printf("         Session     Total");
+	commands_printf("Wh     : %-11.3f %.3f", session.wh, total.wh);
+	commands_printf("Ah     : %-11.3f %.3f", session.ah, total.ah);
+	commands_printf("Peak W : %-11.1f %.1f", (double)session.peak_power, (double)total.peak_power);
+
+	for (int i = 0;i < ENERGY_DUTY_BINS;i++) {
+		commands_printf("Duty %3d-%3d %%: %-11.1f %.1f s",
+				i * 100 / ENERGY_DUTY_BINS, (i + 1) * 100 / ENERGY_DUTY_BINS,
+				(double)session.duty_time[i], (double)total.duty_time[i]);
+	}
+
+	commands_printf(" ");
+}
@@ -0,0 +1,34 @@
+/*
+	Copyright 2021 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC Braking Resistor firmware.
+
+	The VESC Braking Resistor firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC Braking Resistor firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef ENERGY_H_
+#define ENERGY_H_
+
+#include "datatypes.h"
+
+// Functions
+void energy_init(void);
+void energy_sample(float v_in, float i_in, float duty, float dt);
+void energy_get_session(energy_stats *stats);
+void energy_get_total(energy_stats *stats);
+void energy_reset_session(void);
+void energy_reset_total(void);
+
+#endif /* ENERGY_H_ */
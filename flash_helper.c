@@ -20,7 +20,12 @@
 #include "flash_helper.h"
 #include "timeout.h"
 #include "main.h"
+#include "utils.h"
+#include "terminal.h"
+#include "commands.h"
+#include "packet.h"
 #include <string.h>
+#include <stddef.h>
 
 #define FLASH_PAGE_MAIN_APP			0
 #define FLASH_PAGE_BACKUP			60
@@ -38,35 +43,141 @@
 #endif
 #define MAX_SIZE_MAIN_APP			(FLASH_PAGES_MAIN_APP * FLASH_PAGE_SIZE)
 
-uint16_t flash_helper_erase_new_app(uint32_t new_app_size) {
-	uint32_t bank = FLASH_BANK_2;
-	uint32_t page = 256;
-	if (*STM32_FLASH_SIZE != 256) {
-		bank = FLASH_BANK_1;
-		page = 64;
-	}
-
-	(void)new_app_size; // TODO: Only erase enough pages to fit the new app
+// The backup pages hold an append-only log of backup data records. A save
+// programs one record after the previous one and only erases a page when the
+// log wraps onto it, so the newest record always survives.
+#define BACKUP_LOG_MAGIC			0x424B4C47
+#define BACKUP_LOG_VERSION			1
+#define BACKUP_LOG_DATA_LEN			((sizeof(backup_data) + 7) & ~7)
+#define BACKUP_LOG_REC_LEN			(sizeof(backup_log_header) + BACKUP_LOG_DATA_LEN)
+#define BACKUP_LOG_ERASED			0xFFFFFFFF
+
+// Settings
+#define ERASE_WAIT_MS				(FLASH_PAGES_MAIN_APP * 50) // Time to wait for pages to be erased
+#define WRITE_BUFFERS				2 // New app chunks that can be queued for programming
+#define WRITE_BUFFER_SIZE			PACKET_MAX_PL_LEN
+
+// Private types
+typedef struct {
+	uint32_t magic;
+	// CRC over the rest of the header and the data
+	uint32_t crc;
+	uint32_t seq;
+	uint16_t len;
+	uint16_t version;
+} backup_log_header;
+
+typedef struct {
+	backup_log_header header;
+	uint8_t data[BACKUP_LOG_DATA_LEN];
+} backup_log_record;
+
+_Static_assert(BACKUP_LOG_REC_LEN <= FLASH_PAGE_SIZE, "A backup log record must fit in one flash page");
+
+typedef struct {
+	uint32_t offset;
+	uint32_t len;
+	uint8_t data[WRITE_BUFFER_SIZE] __attribute__((aligned(8)));
+} write_buffer;
+
+// Threads
+static THD_WORKING_AREA(flash_thread_wa, 384);
+static THD_FUNCTION(flash_thread, arg);
+
+// Private variables
+static MUTEX_DECL(m_backup_mtx);
+static MUTEX_DECL(m_flash_mtx);
+static MUTEX_DECL(m_wr_mtx);
+static thread_t *m_flash_thd = 0;
+static volatile int m_erase_pages = 0;
+static volatile int m_erase_done = 0;
+static volatile uint32_t m_erase_gen = 0;
+static volatile bool m_erase_active = false;
+static volatile bool m_erase_error = false;
+static write_buffer m_wr[WRITE_BUFFERS];
+static volatile int m_wr_head = 0;
+static volatile int m_wr_count = 0;
+static volatile bool m_wr_error = false;
+static uint32_t m_image_size = 0;
+static volatile uint32_t m_stat_bytes = 0;
+static volatile uint32_t m_stat_dwords = 0;
+static volatile uint32_t m_stat_pages = 0;
+static volatile float m_stat_prog_time = 0.0;
+static volatile systime_t m_stat_start = 0;
+static volatile systime_t m_stat_last = 0;
+static backup_log_record m_log_rec __attribute__((aligned(8)));
+static bool m_log_scanned = false;
+static int m_log_page = 0;
+static uint32_t m_log_offset = 0;
+static uint32_t m_log_seq = 0;
+static const backup_log_header *m_log_latest = 0;
+
+// Private functions
+static uint16_t erase_backup_pages(int page, int num);
+static uint16_t erase_new_app_page(int page);
+static bool wait_new_app_erased(int page);
+static bool wait_write_queue(int max);
+static bool enqueue_new_app_data(uint32_t offset, const uint8_t *data, uint32_t len);
+static void terminal_flash_stats(int argc, const char **argv);
+static uint32_t log_crc(const backup_log_header *h);
+static void log_scan(void);
+
+void flash_helper_init(void) {
+	m_flash_thd = chThdCreateStatic(flash_thread_wa, sizeof(flash_thread_wa),
+			NORMALPRIO - 1, flash_thread, NULL);
+
+	terminal_register_command_callback(
+			"flash_stats",
+			"Print programming statistics of the last firmware upload",
+			0,
+			terminal_flash_stats);
+}
 
-	timeout_configure_IWDT_slowest();
+/**
+ * Start erasing the pages that an image of new_app_size bytes needs. This
+ * returns right away, the pages are erased one by one in the background and
+ * flash_helper_write_new_app_data waits for the pages it writes to.
+ *
+ * @param new_app_size
+ * Size of the new image in bytes. 0 erases the entire new app area.
+ *
+ * @return
+ * HAL_OK, or HAL_ERROR if the image does not fit.
+ */
+uint16_t flash_helper_erase_new_app(uint32_t new_app_size) {
+	int pages = (new_app_size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
 
-	HAL_FLASH_Unlock();
-	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+	if (new_app_size == 0) {
+		pages = FLASH_PAGES_MAIN_APP;
+	} else if (pages > FLASH_PAGES_MAIN_APP) {
+		return HAL_ERROR;
+	}
 
-	FLASH_EraseInitTypeDef eType;
-	eType.TypeErase = FLASH_TYPEERASE_PAGES;
-	eType.Banks = bank;
-	eType.Page = page;
-	eType.NbPages = FLASH_PAGES_MAIN_APP;
+	chMtxLock(&m_wr_mtx);
+	m_image_size = new_app_size;
+	chMtxUnlock(&m_wr_mtx);
 
-	uint32_t res = 0;
-	uint16_t res2 = HAL_FLASHEx_Erase(&eType, &res);
+	if (!wait_write_queue(0)) {
+		return HAL_ERROR;
+	}
 
-	HAL_FLASH_Lock();
+	chSysLock();
+	m_erase_gen++;
+	m_erase_pages = pages;
+	m_erase_done = 0;
+	m_erase_error = false;
+	m_erase_active = true;
+	m_wr_error = false;
+	m_stat_bytes = 0;
+	m_stat_dwords = 0;
+	m_stat_pages = 0;
+	m_stat_prog_time = 0.0;
+	m_stat_start = chVTGetSystemTimeX();
+	m_stat_last = m_stat_start;
+	chEvtSignalI(m_flash_thd, (eventmask_t)1);
+	chSysUnlock();
 
-	timeout_configure_IWDT();
-
-	return res2;
+	return HAL_OK;
 }
 
 uint16_t flash_helper_erase_bootloader(void) {
@@ -77,6 +188,8 @@ uint16_t flash_helper_erase_bootloader(void) {
 		page = 124;
 	}
 
+	chMtxLock(&m_flash_mtx);
+
 	timeout_configure_IWDT_slowest();
 
 	HAL_FLASH_Unlock();
@@ -95,18 +208,118 @@ uint16_t flash_helper_erase_bootloader(void) {
 
 	timeout_configure_IWDT();
 
+	chMtxUnlock(&m_flash_mtx);
+
 	return res2;
 }
 
+/**
+ * Write a chunk of the new image. The chunk is copied to a queue and
+ * programmed in the background, so that the next chunk can be received
+ * meanwhile. Programming errors are reported on the following call. The
+ * chunk that reaches the end of the image announced to
+ * flash_helper_erase_new_app has no following call, so it waits until the
+ * whole image is programmed and reports the result itself.
+ *
+ * @param offset
+ * Offset from the start of the new app area.
+ *
+ * @param data
+ * The data, a multiple of 8 bytes.
+ *
+ * @param len
+ * Length of the data.
+ *
+ * @return
+ * HAL_OK, or HAL_ERROR if this or an earlier chunk could not be written.
+ */
 uint16_t flash_helper_write_new_app_data(uint32_t offset, uint8_t *data, uint32_t len) {
-	return flash_helper_write_data(FLASH_ADDRESS_NEW_APP, offset, data, len);
+	if (len == 0) {
+		return HAL_OK;
+	}
+
+	if ((offset + len) > MAX_SIZE_MAIN_APP) {
+		if ((offset + len) > (MAX_SIZE_MAIN_APP + FLASH_PAGES_BOOTLOADER * FLASH_PAGE_SIZE)) {
+			return HAL_ERROR;
+		}
+
+		// The bootloader area follows the new app area and is erased by
+		// flash_helper_erase_bootloader, so it is programmed directly without
+		// erase tracking or queueing.
+		chMtxLock(&m_wr_mtx);
+		bool ok = wait_write_queue(0);
+		if (ok && offset < MAX_SIZE_MAIN_APP) {
+			ok = wait_new_app_erased(FLASH_PAGES_MAIN_APP - 1);
+		}
+		ok = ok && flash_helper_write_data(FLASH_ADDRESS_NEW_APP, offset, data, len) == HAL_OK;
+		chMtxUnlock(&m_wr_mtx);
+
+		return (ok && !m_wr_error) ? HAL_OK : HAL_ERROR;
+	}
+
+	chMtxLock(&m_wr_mtx);
+
+	bool ok;
+
+	if (len > WRITE_BUFFER_SIZE) {
+		// Too large for the queue, write it directly after the queued chunks
+		ok = wait_write_queue(0) &&
+				wait_new_app_erased((offset + len - 1) / FLASH_PAGE_SIZE) &&
+				flash_helper_write_data(FLASH_ADDRESS_NEW_APP, offset, data, len) == HAL_OK;
+	} else {
+		ok = enqueue_new_app_data(offset, data, len);
+	}
+
+	if (ok && m_image_size > 0 && (offset + len) >= m_image_size) {
+		ok = wait_write_queue(0);
+	}
+
+	chMtxUnlock(&m_wr_mtx);
+
+	return (ok && !m_wr_error) ? HAL_OK : HAL_ERROR;
 }
 
+/**
+ * Wait until all queued chunks of the new image are programmed.
+ *
+ * @return
+ * HAL_OK, or HAL_ERROR if a chunk could not be written.
+ */
+uint16_t flash_helper_flush_new_app_data(void) {
+	if (!wait_write_queue(0)) {
+		return HAL_ERROR;
+	}
+
+	return m_wr_error ? HAL_ERROR : HAL_OK;
+}
+
+/**
+ * Program data to erased flash, one double word at a time.
+ *
+ * @param base
+ * Base address.
+ *
+ * @param offset
+ * Offset from base. base + offset has to be 8 byte aligned.
+ *
+ * @param data
+ * The data. The length is rounded down to a multiple of 8 bytes.
+ *
+ * @param len
+ * Length of the data.
+ *
+ * @return
+ * HAL_OK on success, the HAL error otherwise.
+ */
 uint16_t flash_helper_write_data(uint32_t base, uint32_t offset, uint8_t *data, uint32_t len) {
+	chMtxLock(&m_flash_mtx);
+
 	HAL_FLASH_Unlock();
 	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
 
-	for (uint32_t i = 0;i < len;i += 8) {
+	for (uint32_t i = 0;(i + 8) <= len;i += 8) {
+		uint32_t addr = base + offset + i;
+
 		uint64_t dword =
 				((uint64_t) data[i + 7]) << 56 |
 				((uint64_t) data[i + 6]) << 48 |
@@ -118,18 +331,30 @@ uint16_t flash_helper_write_data(uint32_t base, uint32_t offset, uint8_t *data,
 				((uint64_t) data[i + 0]) << 0;
 
 
-		int16_t res = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, base + offset + i, dword);
+		int16_t res = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, dword);
 		if (res != HAL_OK) {
+			HAL_FLASH_Lock();
+			chMtxUnlock(&m_flash_mtx);
 			return res;
 		}
+
+		m_stat_dwords++;
 	}
 
 	HAL_FLASH_Lock();
 
+	chMtxUnlock(&m_flash_mtx);
+
 	return HAL_OK;
 }
 
 void flash_helper_jump_to_bootloader(void) {
+	// The bootloader would reject the image anyway, so keep running the
+	// current firmware if it could not be written completely.
+	if (flash_helper_flush_new_app_data() != HAL_OK) {
+		return;
+	}
+
 	backup.usb_cnt = 3; // Check USB directly after fw-upload to reconenct faster.
 
 	flash_helper_store_backup_data();
@@ -144,6 +369,101 @@ void flash_helper_jump_to_bootloader(void) {
 }
 
 uint16_t flash_helper_erase_backup_data(void) {
+	chMtxLock(&m_backup_mtx);
+	uint16_t res = erase_backup_pages(0, FLASH_PAGES_BACKUP);
+	m_log_scanned = false;
+	chMtxUnlock(&m_backup_mtx);
+	return res;
+}
+
+/**
+ * Append the backup data to the record log in flash. This normally only
+ * programs one record; a page is erased every few saves when the log moves on
+ * to the next page.
+ */
+void flash_helper_store_backup_data(void) {
+	// Stored from both the command handlers and the energy accounting
+	chMtxLock(&m_backup_mtx);
+
+	if (!m_log_scanned) {
+		log_scan();
+	}
+
+	if ((m_log_offset + BACKUP_LOG_REC_LEN) > FLASH_PAGE_SIZE) {
+		m_log_page = (m_log_page + 1) % FLASH_PAGES_BACKUP;
+		m_log_offset = 0;
+
+		// The page after the active one holds the oldest records
+		uint32_t *page = (uint32_t*)(FLASH_ADDRESS_BACKUP + m_log_page * FLASH_PAGE_SIZE);
+		for (uint32_t i = 0;i < FLASH_PAGE_SIZE / 4;i++) {
+			if (page[i] != BACKUP_LOG_ERASED) {
+				erase_backup_pages(m_log_page, 1);
+				break;
+			}
+		}
+
+		if ((uint32_t)m_log_latest >= (uint32_t)page &&
+				(uint32_t)m_log_latest < ((uint32_t)page + FLASH_PAGE_SIZE)) {
+			m_log_latest = 0;
+		}
+	}
+
+	backup.conf_flash_write_cnt++;
+
+	// Take a consistent snapshot, as the energy accounting updates the
+	// backup data while this runs.
+	memset(&m_log_rec, 0, sizeof(m_log_rec));
+	chSysLock();
+	memcpy(m_log_rec.data, (void*)&backup, sizeof(backup_data));
+	chSysUnlock();
+
+	m_log_seq++;
+	m_log_rec.header.magic = BACKUP_LOG_MAGIC;
+	m_log_rec.header.seq = m_log_seq;
+	m_log_rec.header.len = sizeof(backup_data);
+	m_log_rec.header.version = BACKUP_LOG_VERSION;
+	m_log_rec.header.crc = log_crc(&m_log_rec.header);
+
+	uint32_t offset = m_log_page * FLASH_PAGE_SIZE + m_log_offset;
+	if (flash_helper_write_data(FLASH_ADDRESS_BACKUP, offset,
+			(uint8_t*)&m_log_rec, sizeof(m_log_rec)) == HAL_OK) {
+		m_log_latest = (const backup_log_header*)(FLASH_ADDRESS_BACKUP + offset);
+	}
+
+	// A failed write leaves a record that fails the CRC check, so skip past
+	// it either way.
+	m_log_offset += BACKUP_LOG_REC_LEN;
+
+	chMtxUnlock(&m_backup_mtx);
+}
+
+void flash_helper_load_backup_data(void) {
+	chMtxLock(&m_backup_mtx);
+
+	log_scan();
+
+	if (m_log_latest) {
+		// Records from older firmware can be shorter. The init flags catch the
+		// entries that are missing.
+		uint32_t len = m_log_latest->len;
+		if (len > sizeof(backup_data)) {
+			len = sizeof(backup_data);
+		}
+
+		memset((void*)&backup, 0, sizeof(backup_data));
+		memcpy((void*)&backup, (uint8_t*)m_log_latest + sizeof(backup_log_header), len);
+	} else if (*((uint32_t*)FLASH_ADDRESS_BACKUP) == VAR_INIT_CODE) {
+		// Firmware before the log stored the plain struct at the start of
+		// the backup pages.
+		memcpy((void*)&backup, (uint8_t*)FLASH_ADDRESS_BACKUP, sizeof(backup_data));
+	}
+
+	chMtxUnlock(&m_backup_mtx);
+}
+
+static uint16_t erase_backup_pages(int page, int num) {
+	chMtxLock(&m_flash_mtx);
+
 	timeout_configure_IWDT_slowest();
 
 	HAL_FLASH_Unlock();
@@ -152,8 +472,8 @@ uint16_t flash_helper_erase_backup_data(void) {
 	FLASH_EraseInitTypeDef eType;
 	eType.TypeErase = FLASH_TYPEERASE_PAGES;
 	eType.Banks = FLASH_BANK_BACKUP;
-	eType.Page = FLASH_PAGE_BACKUP;
-	eType.NbPages = FLASH_PAGES_BACKUP;
+	eType.Page = FLASH_PAGE_BACKUP + page;
+	eType.NbPages = num;
 
 	uint32_t res = 0;
 	uint16_t res2 = HAL_FLASHEx_Erase(&eType, &res);
@@ -162,15 +482,297 @@ uint16_t flash_helper_erase_backup_data(void) {
 
 	timeout_configure_IWDT();
 
+	chMtxUnlock(&m_flash_mtx);
+
 	return res2;
 }
 
-void flash_helper_store_backup_data(void) {
-	backup.conf_flash_write_cnt++;
-	flash_helper_erase_backup_data();
-	flash_helper_write_data(FLASH_ADDRESS_BACKUP, 0, (void*)&backup, sizeof(backup_data));
+/*
+ * Erase one page of the new app area. A single page takes around 25 ms, which
+ * is well within the watchdog timeout.
+ */
+static uint16_t erase_new_app_page(int page) {
+	uint32_t bank = FLASH_BANK_2;
+	uint32_t first = 256;
+	if (*STM32_FLASH_SIZE != 256) {
+		bank = FLASH_BANK_1;
+		first = 64;
+	}
+
+	chMtxLock(&m_flash_mtx);
+
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+
+	FLASH_EraseInitTypeDef eType;
+	eType.TypeErase = FLASH_TYPEERASE_PAGES;
+	eType.Banks = bank;
+	eType.Page = first + page;
+	eType.NbPages = 1;
+
+	uint32_t res = 0;
+	uint16_t res2 = HAL_FLASHEx_Erase(&eType, &res);
+
+	HAL_FLASH_Lock();
+
+	chMtxUnlock(&m_flash_mtx);
+
+	return res2;
 }
 
-void flash_helper_load_backup_data(void) {
-	memcpy((void*)&backup, (uint8_t*)FLASH_ADDRESS_BACKUP, sizeof(backup_data));
+/*
+ * Wait until the new app area is erased up to and including page. Writes past
+ * the announced image size extend the erase. Before the first erase request
+ * since boot nothing is tracked, so writes go straight to flash as before.
+ */
+static bool wait_new_app_erased(int page) {
+	chSysLock();
+	if (!m_erase_active) {
+		chSysUnlock();
+		return true;
+	}
+
+	if (m_erase_pages <= page) {
+		m_erase_pages = page + 1;
+		chEvtSignalI(m_flash_thd, (eventmask_t)1);
+	}
+	chSysUnlock();
+
+	systime_t start = chVTGetSystemTimeX();
+	while (m_erase_done <= page) {
+		if (m_erase_error || chVTTimeElapsedSinceX(start) > TIME_MS2I(ERASE_WAIT_MS)) {
+			return false;
+		}
+		chThdSleepMilliseconds(1);
+	}
+
+	return true;
+}
+
+/*
+ * Wait until at most max chunks are queued for programming.
+ */
+static bool wait_write_queue(int max) {
+	systime_t start = chVTGetSystemTimeX();
+	while (m_wr_count > max) {
+		if (chVTTimeElapsedSinceX(start) > TIME_MS2I(ERASE_WAIT_MS)) {
+			return false;
+		}
+		chThdSleepMilliseconds(1);
+	}
+
+	return true;
+}
+
+/*
+ * Copy a chunk to the queue of the flash thread, waiting for a free buffer.
+ * Called with m_wr_mtx locked, so only one thread adds to the queue and the
+ * slot stays free.
+ */
+static bool enqueue_new_app_data(uint32_t offset, const uint8_t *data, uint32_t len) {
+	if (!wait_write_queue(WRITE_BUFFERS - 1)) {
+		return false;
+	}
+
+	chSysLock();
+	write_buffer *wr = &m_wr[(m_wr_head + m_wr_count) % WRITE_BUFFERS];
+	chSysUnlock();
+
+	memcpy(wr->data, data, len);
+	wr->offset = offset;
+	wr->len = len;
+
+	chSysLock();
+	m_wr_count++;
+	chEvtSignalI(m_flash_thd, (eventmask_t)1);
+	chSysUnlock();
+
+	return true;
+}
+
+/*
+ * Programs the queued new app chunks and erases the pages of the new app area
+ * ahead of them. Queued chunks go first, and the remaining pages are erased
+ * while waiting for the next chunk.
+ */
+static THD_FUNCTION(flash_thread, arg) {
+	(void)arg;
+
+	chRegSetThreadName("Flash");
+
+	for (;;) {
+		chEvtWaitAny((eventmask_t)1);
+
+		for (;;) {
+			chSysLock();
+			write_buffer *wr = m_wr_count > 0 ? &m_wr[m_wr_head] : 0;
+			bool write_ready = wr != 0;
+
+			if (wr && m_erase_active && !m_erase_error) {
+				int last = (wr->offset + wr->len - 1) / FLASH_PAGE_SIZE;
+				if (m_erase_pages <= last) {
+					m_erase_pages = last + 1;
+				}
+				write_ready = m_erase_done > last;
+			}
+
+			uint32_t gen = m_erase_gen;
+			int page = m_erase_done;
+			bool erase = m_erase_active && !m_erase_error && page < m_erase_pages;
+			bool erase_failed = m_erase_active && m_erase_error;
+			chSysUnlock();
+
+			if (write_ready) {
+				if (erase_failed) {
+					m_wr_error = true;
+				} else {
+					uint32_t t_start = chSysGetRealtimeCounterX();
+					if (flash_helper_write_data(FLASH_ADDRESS_NEW_APP, wr->offset,
+							wr->data, wr->len) != HAL_OK) {
+						m_wr_error = true;
+					}
+					m_stat_prog_time += (float)(chSysGetRealtimeCounterX() - t_start) /
+							(float)SystemCoreClock;
+					m_stat_bytes += wr->len;
+					m_stat_last = chVTGetSystemTimeX();
+				}
+
+				chSysLock();
+				m_wr_head = (m_wr_head + 1) % WRITE_BUFFERS;
+				m_wr_count--;
+				chSysUnlock();
+				continue;
+			}
+
+			if (!erase) {
+				break;
+			}
+
+			uint16_t res = erase_new_app_page(page);
+
+			// Only count the page if no new erase was requested meanwhile
+			chSysLock();
+			if (gen == m_erase_gen) {
+				if (res == HAL_OK) {
+					m_erase_done = page + 1;
+					m_stat_pages++;
+				} else {
+					m_erase_error = true;
+				}
+			}
+			chSysUnlock();
+
+			// Let the command handlers in between the pages
+			chThdYield();
+		}
+	}
+}
+
+static void terminal_flash_stats(int argc, const char **argv) {
+	(void)argc;
+	(void)argv;
+
+	float upload_time = (float)TIME_I2MS(m_stat_last - m_stat_start) / 1000.0;
+
+	commands_printf("Bytes written  : %lu", (unsigned long)m_stat_bytes);
+	commands_printf("Double words   : %lu", (unsigned long)m_stat_dwords);
+	commands_printf("Pages erased   : %lu", (unsigned long)m_stat_pages);
+	commands_printf("Program rate   : %.0f B/s", m_stat_prog_time > 0.0 ?
+			(double)(m_stat_bytes / m_stat_prog_time) : 0.0);
+	commands_printf("Upload rate    : %.0f B/s\n", upload_time > 0.0 ?
+			(double)(m_stat_bytes / upload_time) : 0.0);
+}
+
+static bool log_header_valid(const backup_log_header *h, uint32_t space) {
+	return h->magic == BACKUP_LOG_MAGIC &&
+			h->len > 0 && (h->len + sizeof(backup_log_header)) <= space;
+}
+
+static uint32_t log_rec_len(const backup_log_header *h) {
+	return sizeof(backup_log_header) + ((h->len + 7) & ~7);
+}
+
+static uint32_t log_crc(const backup_log_header *h) {
+	return utils_crc32c((uint8_t*)&h->seq,
+			sizeof(backup_log_header) - offsetof(backup_log_header, seq) + h->len);
+}
+
+/*
+ * Walk the records of one page. Returns the newest record with a valid CRC, or
+ * null, and updates the sequence number and the offset where the next record
+ * can go.
+ */
+static const backup_log_header *log_walk(int page, uint32_t *offset, uint32_t *seq) {
+	uint32_t base = FLASH_ADDRESS_BACKUP + page * FLASH_PAGE_SIZE;
+	const backup_log_header *latest = 0;
+	*offset = 0;
+
+	while ((*offset + sizeof(backup_log_header)) <= FLASH_PAGE_SIZE) {
+		const backup_log_header *h = (const backup_log_header*)(base + *offset);
+
+		if (h->magic == BACKUP_LOG_ERASED) {
+			break;
+		}
+
+		if (!log_header_valid(h, FLASH_PAGE_SIZE - *offset)) {
+			// Torn header, don't append anything more to this page
+			*offset = FLASH_PAGE_SIZE;
+			break;
+		}
+
+		if (h->crc == log_crc(h)) {
+			latest = h;
+		}
+
+		if ((int32_t)(h->seq - *seq) > 0) {
+			*seq = h->seq;
+		}
+
+		*offset += log_rec_len(h);
+	}
+
+	return latest;
+}
+
+/*
+ * Find the active page and the newest valid record. Every page starts with a
+ * record, so comparing the first sequence number of each page picks the active
+ * one and normally only that page has to be walked.
+ */
+static void log_scan(void) {
+	m_log_scanned = true;
+	m_log_page = 0;
+	m_log_offset = 0;
+	m_log_seq = 0;
+	m_log_latest = 0;
+
+	bool found = false;
+
+	for (int i = 0;i < FLASH_PAGES_BACKUP;i++) {
+		const backup_log_header *h =
+				(const backup_log_header*)(FLASH_ADDRESS_BACKUP + i * FLASH_PAGE_SIZE);
+		if (log_header_valid(h, FLASH_PAGE_SIZE) &&
+				(!found || (int32_t)(h->seq - m_log_seq) > 0)) {
+			found = true;
+			m_log_seq = h->seq;
+			m_log_page = i;
+		}
+	}
+
+	if (!found) {
+		// Empty or legacy layout. Start over at the first page, which is
+		// erased before the first record goes there.
+		m_log_page = FLASH_PAGES_BACKUP - 1;
+		m_log_offset = FLASH_PAGE_SIZE;
+		return;
+	}
+
+	m_log_latest = log_walk(m_log_page, &m_log_offset, &m_log_seq);
+
+	// If the newest records are damaged, fall back to older pages
+	for (int i = 1;i < FLASH_PAGES_BACKUP && !m_log_latest;i++) {
+		uint32_t offset, seq = m_log_seq;
+		int page = (m_log_page + FLASH_PAGES_BACKUP - i) % FLASH_PAGES_BACKUP;
+		m_log_latest = log_walk(page, &offset, &seq);
+	}
 }
@@ -24,10 +24,12 @@
 #include "stm32l4xx_hal_conf.h"
 
 // Functions
+void flash_helper_init(void);
 uint16_t flash_helper_erase_new_app(uint32_t new_app_size);
 uint16_t flash_helper_erase_bootloader(void);
 uint16_t flash_helper_write_new_app_data(uint32_t offset, uint8_t *data, uint32_t len);
 uint16_t flash_helper_write_data(uint32_t base, uint32_t offset, uint8_t *data, uint32_t len);
+uint16_t flash_helper_flush_new_app_data(void);
 void flash_helper_jump_to_bootloader(void);
 uint16_t flash_helper_erase_backup_data(void);
 void flash_helper_store_backup_data(void);
@@ -0,0 +1,149 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Control laws of the automatic load control. They only depend on their
+ * arguments, so that they can be tested on the host (see tests/load_ctrl).
+ */
+
+#include "load_ctrl.h"
+
+/**
+ * Linear map from the input voltage to the duty cycle.
+ *
+ * @param v_in
+ * Input voltage.
+ *
+ * @param v_start
+ * Voltage where the load starts.
+ *
+ * @param v_max
+ * Voltage where the duty cycle reaches out_max.
+ *
+ * @param out_max
+ * Maximum duty cycle.
+ *
+ * @return
+ * The duty cycle, or -1.0 below v_start.
+ */
+float load_ctrl_linear(float v_in, float v_start, float v_max, float out_max) {
+	if (v_in < v_start) {
+		return -1.0;
+	} else if (v_in > v_max) {
+		return out_max;
+	}
+
+	return (v_in - v_start) * out_max / (v_max - v_start);
+}
+
+/**
+ * PI regulator of the input voltage. The integrator is clamped to the part of
+ * the output range that the proportional part leaves free, so that it does not
+ * wind up while the output is saturated or the input voltage is below the
+ * setpoint. The feed-forward duty cycle ff is added to the output, and the
+ * regulator only trims it, so its range is shifted down by ff.
+ *
+ * @param integral
+ * Integrator state, 0 to start with.
+ *
+ * @param v_in
+ * Input voltage.
+ *
+ * @param v_set
+ * Voltage setpoint.
+ *
+ * @param kp
+ * Proportional gain, duty cycle per volt.
+ *
+ * @param ki
+ * Integral gain, duty cycle per volt and second.
+ *
+ * @param dt
+ * Time since the previous call in seconds.
+ *
+ * @param ff
+ * Feed-forward duty cycle.
+ *
+ * @param out_max
+ * Maximum duty cycle.
+ *
+ * @return
+ * The duty cycle, 0 to out_max.
+ */
+float load_ctrl_pi(float *integral, float v_in, float v_set, float kp, float ki,
+		float dt, float ff, float out_max) {
+	if (ff > out_max) {
+		ff = out_max;
+	}
+
+	float error = v_in - v_set;
+	float p = error * kp;
+	float i = *integral + error * ki * dt;
+
+	// Leave room for the proportional part. An integrator at the limit while
+	// the input voltage is far above the setpoint keeps the load on after the
+	// voltage has come down.
+	float i_max = out_max - ff - (p > 0.0 ? p : 0.0);
+	if (i > i_max) {
+		i = i_max;
+	}
+
+	if (i < -ff) {
+		i = -ff;
+	}
+	*integral = i;
+
+	float out = p + i;
+
+	if (out > (out_max - ff)) {
+		out = out_max - ff;
+	} else if (out < -ff) {
+		out = -ff;
+	}
+
+	return out + ff;
+}
+
+/**
+ * Duty cycle that dissipates the regenerative power at the present input
+ * voltage. The resistor takes v_in^2 / load_res at full duty, so the duty
+ * cycle for the current i_regen is i_regen * load_res / v_in.
+ *
+ * @param i_regen
+ * Regenerative current in A.
+ *
+ * @param v_in
+ * Input voltage.
+ *
+ * @param load_res
+ * Resistance of the load.
+ *
+ * @param gain
+ * Fraction of the regenerative power to take.
+ *
+ * @return
+ * The duty cycle, 0 when there is no regenerative current.
+ */
+float load_ctrl_ff(float i_regen, float v_in, float load_res, float gain) {
+	if (i_regen <= 0.0 || load_res <= 0.0 || v_in < 1.0) {
+		return 0.0;
+	}
+
+	return gain * i_regen * load_res / v_in;
+}
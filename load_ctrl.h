@@ -0,0 +1,29 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOAD_CTRL_H_
+#define LOAD_CTRL_H_
+
+// Functions
+float load_ctrl_linear(float v_in, float v_start, float v_max, float out_max);
+float load_ctrl_pi(float *integral, float v_in, float v_set, float kp, float ki,
+		float dt, float ff, float out_max);
+float load_ctrl_ff(float i_regen, float v_in, float load_res, float gain);
+
+#endif /* LOAD_CTRL_H_ */
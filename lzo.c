@@ -0,0 +1,219 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "lzo.h"
+
+// Bounds checks. Every read from the input, write to the output and match
+// reference is checked, so corrupt data cannot get outside of the buffers.
+// Before each instruction byte, the two bytes that can follow it are checked
+// as well. A valid stream always has them, as it ends with a three byte
+// marker.
+#define NEED_IP(n)		if ((uint32_t)(ip_end - ip) < (uint32_t)(n)) goto input_overrun
+#define NEED_OP(n)		if ((uint32_t)(op_end - op) < (uint32_t)(n)) goto output_overrun
+#define TEST_LB(m)		if ((m) < out || (m) >= op) goto lookbehind_overrun
+
+#define M2_MAX_OFFSET	0x0800
+
+/**
+ * Decompress one LZO1X block, as produced by lzo1x_1_compress and
+ * lzo1x_999_compress. Matches only refer back into the output buffer, so no
+ * other memory than the output buffer is needed.
+ *
+ * @param in
+ * Compressed data.
+ *
+ * @param in_len
+ * Length of the compressed data.
+ *
+ * @param out
+ * Buffer for the decompressed data.
+ *
+ * @param out_len
+ * Size of the output buffer. Set to the decompressed length.
+ *
+ * @return
+ * LZO_E_OK on success, one of the LZO_E_ error codes otherwise.
+ */
+int lzo_decompress(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t *out_len) {
+	const uint8_t *ip = in;
+	const uint8_t *ip_end = in + in_len;
+	uint8_t *op = out;
+	uint8_t *op_end = out + *out_len;
+	const uint8_t *m_pos;
+	uint32_t t;
+	int res;
+
+	*out_len = 0;
+
+	NEED_IP(1);
+	if (*ip > 17) {
+		t = *ip++ - 17;
+		if (t < 4) {
+			goto match_next;
+		}
+
+		NEED_OP(t);
+		NEED_IP(t + 3);
+		do {
+			*op++ = *ip++;
+		} while (--t > 0);
+		goto first_literal_run;
+	}
+
+	for (;;) {
+		NEED_IP(3);
+		t = *ip++;
+		if (t >= 16) {
+			goto match;
+		}
+
+		// Literal run
+		if (t == 0) {
+			while (*ip == 0) {
+				t += 255;
+				ip++;
+				NEED_IP(1);
+			}
+			t += 15 + *ip++;
+		}
+
+		NEED_OP(t + 3);
+		NEED_IP(t + 6);
+		t += 3;
+		do {
+			*op++ = *ip++;
+		} while (--t > 0);
+
+first_literal_run:
+		t = *ip++;
+		if (t >= 16) {
+			goto match;
+		}
+
+		// Three byte match right after a literal run
+		m_pos = op - (1 + M2_MAX_OFFSET);
+		m_pos -= t >> 2;
+		m_pos -= *ip++ << 2;
+		TEST_LB(m_pos);
+		NEED_OP(3);
+		*op++ = *m_pos++;
+		*op++ = *m_pos++;
+		*op++ = *m_pos;
+		goto match_done;
+
+		for (;;) {
+match:
+			if (t >= 64) {
+				// M2: 3 - 8 bytes, offset up to 2 KiB
+				m_pos = op - 1;
+				m_pos -= (t >> 2) & 7;
+				m_pos -= *ip++ << 3;
+				t = (t >> 5) - 1;
+			} else if (t >= 32) {
+				// M3: offset up to 16 KiB
+				t &= 31;
+				if (t == 0) {
+					while (*ip == 0) {
+						t += 255;
+						ip++;
+						NEED_IP(1);
+					}
+					t += 31 + *ip++;
+					NEED_IP(2);
+				}
+				m_pos = op - 1;
+				m_pos -= (ip[0] >> 2) + (ip[1] << 6);
+				ip += 2;
+			} else if (t >= 16) {
+				// M4: offset up to 48 KiB, or the end marker
+				m_pos = op;
+				m_pos -= (t & 8) << 11;
+				t &= 7;
+				if (t == 0) {
+					while (*ip == 0) {
+						t += 255;
+						ip++;
+						NEED_IP(1);
+					}
+					t += 7 + *ip++;
+					NEED_IP(2);
+				}
+				m_pos -= (ip[0] >> 2) + (ip[1] << 6);
+				ip += 2;
+				if (m_pos == op) {
+					goto eof_found;
+				}
+				m_pos -= 0x4000;
+			} else {
+				// M1: two bytes after a short literal run
+				m_pos = op - 1;
+				m_pos -= t >> 2;
+				m_pos -= *ip++ << 2;
+				TEST_LB(m_pos);
+				NEED_OP(2);
+				*op++ = *m_pos++;
+				*op++ = *m_pos;
+				goto match_done;
+			}
+
+			TEST_LB(m_pos);
+			NEED_OP(t + 2);
+			*op++ = *m_pos++;
+			*op++ = *m_pos++;
+			do {
+				*op++ = *m_pos++;
+			} while (--t > 0);
+
+match_done:
+			t = ip[-2] & 3;
+			if (t == 0) {
+				break;
+			}
+
+match_next:
+			// Up to three literals follow the match
+			NEED_OP(t);
+			NEED_IP(t + 3);
+			do {
+				*op++ = *ip++;
+			} while (--t > 0);
+			t = *ip++;
+		}
+	}
+
+eof_found:
+	*out_len = op - out;
+	return ip == ip_end ? LZO_E_OK :
+			(ip < ip_end ? LZO_E_INPUT_NOT_CONSUMED : LZO_E_INPUT_OVERRUN);
+
+input_overrun:
+	res = LZO_E_INPUT_OVERRUN;
+	goto error;
+
+output_overrun:
+	res = LZO_E_OUTPUT_OVERRUN;
+	goto error;
+
+lookbehind_overrun:
+	res = LZO_E_LOOKBEHIND_OVERRUN;
+
+error:
+	*out_len = op - out;
+	return res;
+}
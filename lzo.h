@@ -0,0 +1,35 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef LZO_H_
+#define LZO_H_
+
+#include <stdint.h>
+
+// Return codes, same values as in the LZO library
+#define LZO_E_OK					0
+#define LZO_E_INPUT_OVERRUN			-4
+#define LZO_E_OUTPUT_OVERRUN		-5
+#define LZO_E_LOOKBEHIND_OVERRUN	-6
+#define LZO_E_INPUT_NOT_CONSUMED	-8
+
+// Functions
+int lzo_decompress(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t *out_len);
+
+#endif /* LZO_H_ */
@@ -30,6 +30,9 @@
 #include "comm_uart.h"
 #include "hw.h"
 #include "resistor.h"
+#include "energy.h"
+#include "telemetry.h"
+#include "capture.h"
 
 #include <math.h>
 #include <string.h>
@@ -51,6 +54,8 @@ int main(void) {
 	// saves power.
 	DBGMCU->CR = DBGMCU_CR_DBG_STOP;
 
+	flash_helper_init();
+
 	// If there is no backup data in RAM try to load it from flash. This can
 	// happen if power was lost.
 	if (backup.controller_id_init_flag != VAR_INIT_CODE ||
@@ -93,6 +98,11 @@ int main(void) {
 		backup.hw_config_init_flag = VAR_INIT_CODE_HW_CONF;
 	}
 
+	if (backup.energy_init_flag != VAR_INIT_CODE) {
+		memset((void*)&backup.energy, 0, sizeof(backup.energy));
+		backup.energy_init_flag = VAR_INIT_CODE;
+	}
+
 	if (backup.config_init_flag != MAIN_CONFIG_T_SIGNATURE) {
 		confparser_set_defaults_main_config_t((main_config_t*)(&backup.config));
 		backup.config_init_flag = MAIN_CONFIG_T_SIGNATURE;
@@ -127,6 +137,7 @@ int main(void) {
 	}
 
 	pwr_init();
+	conf_general_init();
 	comm_can_init();
 	comm_can_set_baud(backup.config.can_baud_rate);
 
@@ -135,6 +146,9 @@ int main(void) {
 #endif
 
 	resistor_init();
+	energy_init();
+	telemetry_init();
+	capture_init();
 
 //	timeout_init();
 
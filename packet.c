@@ -22,6 +22,7 @@
 #include "crc.h"
 
 // Private functions
+static unsigned int next_start(const unsigned char *buffer, unsigned int len);
 static int try_decode_packet(unsigned char *buffer, unsigned int in_len,
 		void(*process_func)(unsigned char *data, unsigned int len), int *bytes_left);
 
@@ -39,6 +40,31 @@ void packet_reset(PACKET_STATE_t *state) {
 }
 
 void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *state) {
+	packet_seg_t seg = {data, len};
+	packet_send_packet_seg(&seg, 1, state);
+}
+
+/**
+ * Send a packet with the payload given as several segments, e.g. a header
+ * followed by a large buffer. The segments are copied directly into the
+ * transmit buffer and the CRC is calculated along the way, so the caller
+ * does not have to assemble the payload in a buffer of its own first.
+ *
+ * @param segs
+ * The payload segments, in order.
+ *
+ * @param seg_num
+ * Number of segments.
+ *
+ * @param state
+ * The packet state to send with.
+ */
+void packet_send_packet_seg(const packet_seg_t *segs, int seg_num, PACKET_STATE_t *state) {
+	unsigned int len = 0;
+	for (int i = 0;i < seg_num;i++) {
+		len += segs[i].len;
+	}
+
 	if (len == 0 || len > PACKET_MAX_PL_LEN) {
 		return;
 	}
@@ -59,10 +85,13 @@ void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *s
 		state->tx_buffer[b_ind++] = len & 0xFF;
 	}
 
-	memcpy(state->tx_buffer + b_ind, data, len);
-	b_ind += len;
+	unsigned short crc = 0;
+	for (int i = 0;i < seg_num;i++) {
+		memcpy(state->tx_buffer + b_ind, segs[i].data, segs[i].len);
+		b_ind += segs[i].len;
+		crc = crc16_update(crc, segs[i].data, segs[i].len);
+	}
 
-	unsigned short crc = crc16(data, len);
 	state->tx_buffer[b_ind++] = (uint8_t)(crc >> 8);
 	state->tx_buffer[b_ind++] = (uint8_t)(crc & 0xFF);
 	state->tx_buffer[b_ind++] = 3;
@@ -73,62 +102,114 @@ void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *s
 }
 
 void packet_process_byte(uint8_t rx_data, PACKET_STATE_t *state) {
-	unsigned int data_len = state->rx_write_ptr - state->rx_read_ptr;
-
-	// Out of space (should not happen)
-	if (data_len >= PACKET_BUFFER_LEN) {
-		state->rx_write_ptr = 0;
-		state->rx_read_ptr = 0;
-		state->bytes_left = 0;
-		state->rx_buffer[state->rx_write_ptr++] = rx_data;
-		return;
-	}
+	packet_process_buffer(&rx_data, 1, state);
+}
 
-	// Everything has to be aligned, so shift buffer if we are out of space.
-	// (as opposed to using a circular buffer)
-	if (state->rx_write_ptr >= PACKET_BUFFER_LEN) {
-		memmove(state->rx_buffer,
-				state->rx_buffer + state->rx_read_ptr,
-				data_len);
+/**
+ * Process a span of received bytes. The bytes are appended to the receive
+ * buffer in as few copies as possible and decoding is only attempted once
+ * enough bytes for the next step have arrived, so this is much cheaper than
+ * calling packet_process_byte for every byte.
+ *
+ * @param data
+ * The received bytes.
+ *
+ * @param len
+ * Number of received bytes.
+ *
+ * @param state
+ * The packet state to decode with.
+ */
+void packet_process_buffer(const uint8_t *data, unsigned int len, PACKET_STATE_t *state) {
+	while (len > 0) {
+		unsigned int data_len = state->rx_write_ptr - state->rx_read_ptr;
+
+		// Out of space (should not happen)
+		if (data_len >= PACKET_BUFFER_LEN) {
+			state->rx_write_ptr = 0;
+			state->rx_read_ptr = 0;
+			state->bytes_left = 0;
+			data_len = 0;
+		}
 
-		state->rx_read_ptr = 0;
-		state->rx_write_ptr = data_len;
-	}
+		// Everything has to be aligned, so shift buffer if we are out of space.
+		// (as opposed to using a circular buffer)
+		if (state->rx_write_ptr >= PACKET_BUFFER_LEN) {
+			memmove(state->rx_buffer,
+					state->rx_buffer + state->rx_read_ptr,
+					data_len);
 
-	state->rx_buffer[state->rx_write_ptr++] = rx_data;
-	data_len++;
+			state->rx_read_ptr = 0;
+			state->rx_write_ptr = data_len;
+		}
 
-	if (state->bytes_left > 1) {
-		state->bytes_left--;
-		return;
-	}
+		unsigned int num = PACKET_BUFFER_LEN - state->rx_write_ptr;
+		if (num > len) {
+			num = len;
+		}
+
+		memcpy(state->rx_buffer + state->rx_write_ptr, data, num);
+		state->rx_write_ptr += num;
+		data_len += num;
+		data += num;
+		len -= num;
 
-	// Try decoding the packet at various offsets until it succeeds, or
-	// until we run out of data.
-	for (;;) {
-		int res = try_decode_packet(state->rx_buffer + state->rx_read_ptr,
-				data_len, state->process_func, &state->bytes_left);
+		if (state->bytes_left > (int)num) {
+			state->bytes_left -= num;
+			continue;
+		}
 
-		// More data is needed
-		if (res == -2) {
-			break;
+		// Try decoding the packet at various offsets until it succeeds, or
+		// until we run out of data.
+		for (;;) {
+			int res = try_decode_packet(state->rx_buffer + state->rx_read_ptr,
+					data_len, state->process_func, &state->bytes_left);
+
+			// More data is needed
+			if (res == -2) {
+				break;
+			}
+
+			if (res > 0) {
+				data_len -= res;
+				state->rx_read_ptr += res;
+			} else if (res == -1) {
+				// Something went wrong. Skip to the next possible start byte
+				// and try again.
+				unsigned int skip = next_start(state->rx_buffer + state->rx_read_ptr, data_len);
+				state->rx_read_ptr += skip;
+				data_len -= skip;
+			}
 		}
 
-		if (res > 0) {
-			data_len -= res;
-			state->rx_read_ptr += res;
-		} else if (res == -1) {
-			// Something went wrong. Move pointer forward and try again.
-			state->rx_read_ptr++;
-			data_len--;
+		// Nothing left, move pointers to avoid memmove
+		if (data_len == 0) {
+			state->rx_read_ptr = 0;
+			state->rx_write_ptr = 0;
 		}
 	}
+}
 
-	// Nothing left, move pointers to avoid memmove
-	if (data_len == 0) {
-		state->rx_read_ptr = 0;
-		state->rx_write_ptr = 0;
+/**
+ * Find the next byte that can start a packet.
+ *
+ * @param buffer
+ * The buffer to search. The first byte is skipped.
+ *
+ * @param len
+ * The length of the buffer.
+ *
+ * @return
+ * Offset of the next start byte, or len if there is none.
+ */
+static unsigned int next_start(const unsigned char *buffer, unsigned int len) {
+	for (unsigned int i = 1;i < len;i++) {
+		if (buffer[i] == 2 || buffer[i] == 3 || buffer[i] == 4) {
+			return i;
+		}
 	}
+
+	return len;
 }
 
 /**
@@ -31,6 +31,11 @@
 #define PACKET_BUFFER_LEN		(PACKET_MAX_PL_LEN + 8)
 
 // Types
+typedef struct {
+	const unsigned char *data;
+	unsigned int len;
+} packet_seg_t;
+
 typedef struct {
 	void(*send_func)(unsigned char *data, unsigned int len);
 	void(*process_func)(unsigned char *data, unsigned int len);
@@ -46,6 +51,8 @@ void packet_init(void (*s_func)(unsigned char *data, unsigned int len),
 		void (*p_func)(unsigned char *data, unsigned int len), PACKET_STATE_t *state);
 void packet_reset(PACKET_STATE_t *state);
 void packet_process_byte(uint8_t rx_data, PACKET_STATE_t *state);
+void packet_process_buffer(const uint8_t *data, unsigned int len, PACKET_STATE_t *state);
 void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *state);
+void packet_send_packet_seg(const packet_seg_t *segs, int seg_num, PACKET_STATE_t *state);
 
 #endif /* PACKET_H_ */
@@ -24,101 +24,125 @@
 
 // Settings
 #define ADC_CHANNELS	11
+#define ADC_SAMPLES		4 // Sequences averaged for each half of the DMA buffer
+#define ADC_BUF_DEPTH	(2 * ADC_SAMPLES)
+#define ADC_SMP_SLOW	ADC_SMPR_SMP_92P5
+#define ADC_SMP_FAST	ADC_SMPR_SMP_24P5 // Current and input voltage, about 0.5 us per conversion
+
+// Sample time bits of a channel in SMPR1 and SMPR2
+#define ADC_SMPR1_CH(ch, smp)	((ch) < 10 ? ((uint32_t)(smp) << ((ch) * 3)) : 0U)
+#define ADC_SMPR2_CH(ch, smp)	((ch) >= 10 ? ((uint32_t)(smp) << (((ch) - 10) * 3)) : 0U)
+
+// Replace the slow sample time of the current and input voltage channels
+#define ADC_SMPR_FAST(n, slow) \
+	(((slow) & ~(ADC_SMPR##n##_CH(ADC_CH_CURRENT, 7U) | ADC_SMPR##n##_CH(ADC_CH_VIN, 7U))) | \
+	ADC_SMPR##n##_CH(ADC_CH_CURRENT, ADC_SMP_FAST) | ADC_SMPR##n##_CH(ADC_CH_VIN, ADC_SMP_FAST))
 
 // Private variables
 static volatile float m_v_in = 0.0;
 static volatile float m_i_in = 0.0;
-static volatile float m_temps[HW_ADC_TEMP_SENSORS] = {0.0};
+static volatile float m_temps_adc[HW_ADC_TEMP_SENSORS] = {0.0};
+static adcsample_t m_samples[ADC_BUF_DEPTH * ADC_CHANNELS];
 
-static THD_WORKING_AREA(adc_thd_wa, 2048);
+// Function pointers
+static void(* volatile m_sample_cb)(float v_in, float i_in) = 0;
 
+// Private functions
+static void adc_end_cb(ADCDriver *adcp);
+static void adc_error_cb(ADCDriver *adcp, adcerror_t err);
+
+/*
+ * The sequence is started by TIM1 CH3 at the center of the switching pulse
+ * (see resistor.c). The current and the input voltage are converted first
+ * with short sample times, so that both are taken within about 1 us of the
+ * trigger, far from the switching edges. The temperatures and references
+ * follow at whatever phase they land. The ADC ignores triggers while a
+ * sequence is being converted, so at most one sequence is converted per
+ * switching period.
+ */
 const ADCConversionGroup adcgrpcfg1 = {
-		.circular     = false,
+		.circular     = true,
 		.num_channels = ADC_CHANNELS,
-		.end_cb       = NULL,
-		.error_cb     = NULL,
-		.cfgr         = ADC_CFGR_CONT,
+		.end_cb       = adc_end_cb,
+		.error_cb     = adc_error_cb,
+		.cfgr         = ADC_CFGR_EXTEN_RISING | ADC_CFGR_EXTSEL_SRC(2),
 		.cfgr2        = 0U,
 		.tr1          = ADC_TR(0, 4095),
 		.smpr         = {
-				ADC_SMPR1_SMP_AN0(ADC_SMPR_SMP_92P5) | ADC_SMPR1_SMP_AN1(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR1_SMP_AN2(ADC_SMPR_SMP_92P5) | ADC_SMPR1_SMP_AN3(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR1_SMP_AN4(ADC_SMPR_SMP_92P5) | ADC_SMPR1_SMP_AN5(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR1_SMP_AN6(ADC_SMPR_SMP_92P5) | ADC_SMPR1_SMP_AN7(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR1_SMP_AN8(ADC_SMPR_SMP_92P5) | ADC_SMPR1_SMP_AN9(ADC_SMPR_SMP_92P5),
-				ADC_SMPR2_SMP_AN10(ADC_SMPR_SMP_92P5) | ADC_SMPR2_SMP_AN11(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR2_SMP_AN12(ADC_SMPR_SMP_92P5) | ADC_SMPR2_SMP_AN13(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR2_SMP_AN14(ADC_SMPR_SMP_92P5) | ADC_SMPR2_SMP_AN15(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR2_SMP_AN16(ADC_SMPR_SMP_92P5) | ADC_SMPR2_SMP_AN17(ADC_SMPR_SMP_92P5) |
-				ADC_SMPR2_SMP_AN18(ADC_SMPR_SMP_92P5)
+				ADC_SMPR_FAST(1, ADC_SMPR1_SMP_AN0(ADC_SMP_SLOW) | ADC_SMPR1_SMP_AN1(ADC_SMP_SLOW) |
+				ADC_SMPR1_SMP_AN2(ADC_SMP_SLOW) | ADC_SMPR1_SMP_AN3(ADC_SMP_SLOW) |
+				ADC_SMPR1_SMP_AN4(ADC_SMP_SLOW) | ADC_SMPR1_SMP_AN5(ADC_SMP_SLOW) |
+				ADC_SMPR1_SMP_AN6(ADC_SMP_SLOW) | ADC_SMPR1_SMP_AN7(ADC_SMP_SLOW) |
+				ADC_SMPR1_SMP_AN8(ADC_SMP_SLOW) | ADC_SMPR1_SMP_AN9(ADC_SMP_SLOW)),
+				ADC_SMPR_FAST(2, ADC_SMPR2_SMP_AN10(ADC_SMP_SLOW) | ADC_SMPR2_SMP_AN11(ADC_SMP_SLOW) |
+				ADC_SMPR2_SMP_AN12(ADC_SMP_SLOW) | ADC_SMPR2_SMP_AN13(ADC_SMP_SLOW) |
+				ADC_SMPR2_SMP_AN14(ADC_SMP_SLOW) | ADC_SMPR2_SMP_AN15(ADC_SMP_SLOW) |
+				ADC_SMPR2_SMP_AN16(ADC_SMP_SLOW) | ADC_SMPR2_SMP_AN17(ADC_SMP_SLOW) |
+				ADC_SMPR2_SMP_AN18(ADC_SMP_SLOW))
 		},
 		.sqr          = {
-				ADC_SQR1_SQ1_N(ADC_CHANNEL_IN0) | ADC_SQR1_SQ2_N(ADC_CH_EX1) |
-				ADC_SQR1_SQ3_N(ADC_CH_CURRENT) | ADC_SQR1_SQ4_N(ADC_CH_TEMP0),
-				ADC_SQR2_SQ5_N(ADC_CH_TEMP1) | ADC_SQR2_SQ6_N(ADC_CH_TEMP2) |
-				ADC_SQR2_SQ7_N(ADC_CH_TEMP3) | ADC_SQR2_SQ8_N(ADC_CH_TEMP4) |
-				ADC_SQR2_SQ9_N(ADC_CH_TEMP5),
-				ADC_SQR3_SQ10_N(ADC_CH_TEMP6) | ADC_SQR3_SQ11_N(ADC_CH_VIN),
+				ADC_SQR1_SQ1_N(ADC_CH_CURRENT) | ADC_SQR1_SQ2_N(ADC_CH_VIN) |
+				ADC_SQR1_SQ3_N(ADC_CHANNEL_IN0) | ADC_SQR1_SQ4_N(ADC_CH_EX1),
+				ADC_SQR2_SQ5_N(ADC_CH_TEMP0) | ADC_SQR2_SQ6_N(ADC_CH_TEMP1) |
+				ADC_SQR2_SQ7_N(ADC_CH_TEMP2) | ADC_SQR2_SQ8_N(ADC_CH_TEMP3) |
+				ADC_SQR2_SQ9_N(ADC_CH_TEMP4),
+				ADC_SQR3_SQ10_N(ADC_CH_TEMP5) | ADC_SQR3_SQ11_N(ADC_CH_TEMP6),
 				0U
 		}
 };
 
-static THD_FUNCTION(adc_thd, p) {
-	(void)p;
-	chRegSetThreadName("ADC");
-
-	adcStart(&ADCD1, NULL);
-	adcSTM32EnableVREF(&ADCD1);
-	chThdSleepMilliseconds(1);
-
-	while (!chThdShouldTerminateX()) {
-		int num_samp = 8;
-		adcsample_t samples[num_samp * ADC_CHANNELS];
-
-		adcConvert(&ADCD1, &adcgrpcfg1, samples, num_samp);
-
-		float v_ex1 = 0.0;
-		float ref = 0.0;
-		float i_in = 0.0;
-		float v_in = 0.0;
-		float temps[HW_ADC_TEMP_SENSORS];
-		memset(temps, 0, sizeof(temps));
-
-		for (int i = 0;i < num_samp;i++) {
-			ref += samples[ADC_CHANNELS * i + 0];
-			v_ex1 += samples[ADC_CHANNELS * i + 1];
-			i_in += samples[ADC_CHANNELS * i + 2];
+/*
+ * Called from the DMA interrupt when one half of the circular buffer has been
+ * filled. The other half is being written by the DMA in the meantime.
+ */
+static void adc_end_cb(ADCDriver *adcp) {
+	adcsample_t *samples = m_samples;
+	if (adcIsBufferComplete(adcp)) {
+		samples += ADC_SAMPLES * ADC_CHANNELS;
+	}
 
-			for (int j = 0;j < HW_ADC_TEMP_SENSORS;j++) {
-				temps[j] += samples[ADC_CHANNELS * i + 3 + j];
-			}
+	uint32_t ref = 0;
+	uint32_t i_in = 0;
+	uint32_t v_in = 0;
+	uint32_t temps[HW_ADC_TEMP_SENSORS];
+	memset(temps, 0, sizeof(temps));
 
-			v_in += samples[ADC_CHANNELS * i + HW_ADC_TEMP_SENSORS + 4];
-		}
-
-		ref /= (float)num_samp;
-		v_ex1 /= (float)num_samp;
-		i_in /= (float)num_samp;
-		v_in /= (float)num_samp;
+	for (int i = 0;i < ADC_SAMPLES;i++) {
+		i_in += samples[ADC_CHANNELS * i + 0];
+		v_in += samples[ADC_CHANNELS * i + 1];
+		ref += samples[ADC_CHANNELS * i + 2];
 
 		for (int j = 0;j < HW_ADC_TEMP_SENSORS;j++) {
-			temps[j] /= (float)num_samp;
+			temps[j] += samples[ADC_CHANNELS * i + 4 + j];
 		}
+	}
 
-		uint16_t vrefint_cal = *((uint16_t*)((uint32_t)0x1FFF75AA));
-		float vdda = (3.0 * (float)vrefint_cal) / (float)ref;
+	uint16_t vrefint_cal = *((uint16_t*)((uint32_t)0x1FFF75AA));
+	float vdda = (3.0 * (float)vrefint_cal) / ((float)ref / (float)ADC_SAMPLES);
 
-		m_v_in = (v_in / (4095.0 / vdda)) * ((R_IN_TOP + R_IN_BOTTOM) / R_IN_BOTTOM);
-		m_i_in = (3.3 * (i_in / 4095.0)) * (1.0 / HW_SHUNT_AMP_GAIN) * (1.0 / HW_SHUNT_RES);
+	m_v_in = (((float)v_in / (float)ADC_SAMPLES) / (4095.0 / vdda)) * ((R_IN_TOP + R_IN_BOTTOM) / R_IN_BOTTOM);
+	m_i_in = (3.3 * (((float)i_in / (float)ADC_SAMPLES) / 4095.0)) * (1.0 / HW_SHUNT_AMP_GAIN) * (1.0 / HW_SHUNT_RES);
 
-		for (int j = 0;j < HW_ADC_TEMP_SENSORS;j++) {
-			m_temps[j] = NTC_TEMP_WITH_IND(temps[j], j);
-		}
+	// The NTC conversion is done when the temperature is read, as it is
+	// too expensive to do in the interrupt.
+	for (int j = 0;j < HW_ADC_TEMP_SENSORS;j++) {
+		m_temps_adc[j] = (float)temps[j] / (float)ADC_SAMPLES;
+	}
 
-		chThdSleepMilliseconds(1);
+	if (m_sample_cb) {
+		m_sample_cb(m_v_in, m_i_in);
 	}
 }
 
+static void adc_error_cb(ADCDriver *adcp, adcerror_t err) {
+	(void)err;
+
+	// Restart the acquisition. The driver has stopped the conversion at this point.
+	chSysLockFromISR();
+	adcStartConversionI(adcp, &adcgrpcfg1, m_samples, ADC_BUF_DEPTH);
+	chSysUnlockFromISR();
+}
+
 void pwr_init(void) {
 	HW_INIT_HOOK();
 
@@ -147,7 +171,23 @@ void pwr_init(void) {
 
 	chThdSleepMilliseconds(10);
 
-	chThdCreateStatic(adc_thd_wa, sizeof(adc_thd_wa), NORMALPRIO, adc_thd, 0);
+	adcStart(&ADCD1, NULL);
+	adcSTM32EnableVREF(&ADCD1);
+	chThdSleepMilliseconds(1);
+
+	adcStartConversion(&ADCD1, &adcgrpcfg1, m_samples, ADC_BUF_DEPTH);
+}
+
+/**
+ * Set a function that is called with every new voltage and current sample.
+ * The function runs in the ADC DMA interrupt, so it must be short and may
+ * only use I-class or X-class API functions.
+ *
+ * @param cb
+ * The callback, or NULL to disable it.
+ */
+void pwr_set_sample_callback(void (*cb)(float v_in, float i_in)) {
+	m_sample_cb = cb;
 }
 
 float pwr_get_vin(void) {
@@ -163,5 +203,5 @@ float pwr_get_temp(int sensor) {
 		return -1.0;
 	}
 
-	return m_temps[sensor];
+	return NTC_TEMP_WITH_IND(m_temps_adc[sensor], sensor);
 }
@@ -46,6 +46,7 @@
 								palClearLine(LINE_TEMP_4_EN); palClearLine(LINE_TEMP_5_EN);
 
 void pwr_init(void);
+void pwr_set_sample_callback(void (*cb)(float v_in, float i_in));
 float pwr_get_vin(void);
 float pwr_get_iin(void);
 float pwr_get_temp(int sensor);
@@ -29,6 +29,11 @@
 #include "stdlib.h"
 #include "pwr.h"
 #include "main.h"
+#include "energy.h"
+#include "telemetry.h"
+#include "capture.h"
+#include "comm_can.h"
+#include "load_ctrl.h"
 
 // Threads
 static THD_WORKING_AREA(resistor_thread_wa, 512);
@@ -37,6 +42,13 @@ static THD_FUNCTION(resistor_thread, arg);
 // Private functions
 static void terminal_pwm(int argc, const char **argv);
 static void terminal_pwm_to(int argc, const char **argv);
+static void set_duty(float pwm);
+static void fast_ctrl(float v_in, float i_in);
+static float ctrl_linear(float v_in);
+static float ctrl_pi(float v_in, float dt, float ff);
+static float ctrl_ff(float v_in);
+static float ff_regen_current(void);
+static void tmod_update(float dt);
 
 // Private variables
 static volatile systime_t m_resistor_set_time = 0;
@@ -46,10 +58,24 @@ static volatile float m_temp_max = 0.0;
 static volatile float m_temp_max_filter = 0.0;
 static volatile float m_pwm_now = 0.0;
 static volatile float m_pwm_max = 1.0;
+static volatile float m_lo_temp = 1.0;
+static volatile float m_lo_volts = 1.0;
+static volatile float m_ff_current = 0.0;
+static float m_pi_integral = 0.0;
+static bool m_auto_active = false;
+static rtcnt_t m_fast_ctrl_last_cnt = 0;
+static bool m_tmod_init_done = false;
+static float m_tmod_settle_time = 0.0;
+static float m_tmod_t_amb = 0.0;
+static float m_tmod_t_hs = 0.0;
+static volatile float m_tmod_t_element = 0.0;
 
 // Settings
 #define DEADTIME_NS			300
 #define F_SW				150000
+#define TMOD_HS_TAU			10.0 // Time constant for correcting the heatsink estimate to the measured temperature
+#define TMOD_AMB_TAU		1800.0 // Time constant for the ambient estimate to follow a rising heatsink temperature
+#define TMOD_SETTLE_S		0.5 // Time for the temperature filter to settle before the model starts
 
 void resistor_init(void) {
 	LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_TIM1);
@@ -57,9 +83,12 @@ void resistor_init(void) {
 	LL_TIM_DeInit(TIM1);
 	TIM1->CNT = 0;
 
-	LL_TIM_SetCounterMode(TIM1, LL_TIM_COUNTERMODE_UP);
+	// Center-aligned, so that the switching pulse is centered on the counter
+	// valley. The counter counts up and down in one period, so the auto
+	// reload value is half of that for edge-aligned PWM.
+	LL_TIM_SetCounterMode(TIM1, LL_TIM_COUNTERMODE_CENTER_UP);
 	LL_TIM_SetPrescaler(TIM1, 0);
-	LL_TIM_SetAutoReload(TIM1, __LL_TIM_CALC_ARR(SystemCoreClock, LL_TIM_GetPrescaler(TIM1), F_SW));
+	LL_TIM_SetAutoReload(TIM1, __LL_TIM_CALC_ARR(SystemCoreClock, LL_TIM_GetPrescaler(TIM1), 2 * F_SW));
 	LL_TIM_EnableARRPreload(TIM1);
 
 	LL_TIM_OC_SetMode(TIM1,  LL_TIM_CHANNEL_CH1,  LL_TIM_OCMODE_PWM1);
@@ -67,6 +96,15 @@ void resistor_init(void) {
 	LL_TIM_OC_SetCompareCH1(TIM1, 0);
 	LL_TIM_OC_EnablePreload(TIM1, LL_TIM_CHANNEL_CH1);
 
+	// Channel 3 is not connected to any pin. It is only active while the
+	// counter is at the valley, so its rising edge triggers the ADC in the
+	// center of the switching pulse at any duty cycle. The center of the on
+	// time is as far from both switching edges as possible, and the middle
+	// of a triangular ripple is its average.
+	LL_TIM_OC_SetMode(TIM1,  LL_TIM_CHANNEL_CH3,  LL_TIM_OCMODE_PWM1);
+	LL_TIM_OC_SetCompareCH3(TIM1, 1);
+	LL_TIM_OC_EnablePreload(TIM1, LL_TIM_CHANNEL_CH3);
+
 	LL_TIM_BDTR_InitTypeDef TIM_BDTRInitStruct;
 	LL_TIM_BDTR_StructInit(&TIM_BDTRInitStruct);
 	TIM_BDTRInitStruct.BreakPolarity = LL_TIM_BREAK_POLARITY_HIGH;
@@ -79,7 +117,7 @@ void resistor_init(void) {
 	TIM_BDTRInitStruct.DeadTime = __LL_TIM_CALC_DEADTIME(SystemCoreClock, LL_TIM_GetClockDivision(TIM1), DEADTIME_NS);
 	LL_TIM_BDTR_Init(TIM1, &TIM_BDTRInitStruct);
 
-	LL_TIM_CC_EnableChannel(TIM1, LL_TIM_CHANNEL_CH1 | LL_TIM_CHANNEL_CH1N);
+	LL_TIM_CC_EnableChannel(TIM1, LL_TIM_CHANNEL_CH1 | LL_TIM_CHANNEL_CH1N | LL_TIM_CHANNEL_CH3);
 	LL_TIM_EnableAllOutputs(TIM1);
 	LL_TIM_EnableCounter(TIM1);
 
@@ -89,6 +127,8 @@ void resistor_init(void) {
 	palSetLineMode(PAL_LINE(GPIOA, 7), PAL_MODE_ALTERNATE(1));
 	palSetLineMode(PAL_LINE(GPIOA, 8), PAL_MODE_ALTERNATE(1));
 
+	pwr_set_sample_callback(fast_ctrl);
+
 	chThdCreateStatic(resistor_thread_wa, sizeof(resistor_thread_wa), NORMALPRIO, resistor_thread, NULL);
 
 	terminal_register_command_callback(
@@ -109,6 +149,9 @@ static THD_FUNCTION(resistor_thread, arg) {
 
 	chRegSetThreadName("Resistor");
 
+	systime_t last_time = chVTGetSystemTimeX();
+	bool temp_limited = false;
+
 	for (;;) {
 		float temp = pwr_get_temp(0);
 		if (pwr_get_temp(1) > temp) {
@@ -120,22 +163,37 @@ static THD_FUNCTION(resistor_thread, arg) {
 		m_temp_max = temp;
 
 		UTILS_LP_FAST(m_temp_max_filter, m_temp_max, 0.05);
-		UTILS_LP_FAST(m_curr_filter, pwr_get_iin(), 0.01);
+		UTILS_LP_FAST(m_curr_filter, pwr_get_iin(), 0.1);
 		UTILS_LP_FAST(m_voltage_filter, pwr_get_vin(), 0.5);
 
+		tmod_update(UTILS_AGE_S(last_time));
+		last_time = chVTGetSystemTimeX();
+
+		// Derate on the estimated element temperature when the model is
+		// enabled, as the temperature sensors lag behind the element.
+		float temp_lim = m_temp_max_filter;
+		if (backup.config.tmod_en && m_tmod_t_element > temp_lim) {
+			temp_lim = m_tmod_t_element;
+		}
+
 		// Apply limits
 		float lo_temp = 0.0;
-		if (m_temp_max_filter < backup.config.temp_lim_start) {
+		if (temp_lim < backup.config.temp_lim_start) {
 			lo_temp = 1.0;
-		} else if (m_temp_max_filter > backup.config.temp_lim_end) {
+		} else if (temp_lim > backup.config.temp_lim_end) {
 			lo_temp = 0.0;
 		} else {
-			lo_temp = utils_map(m_temp_max_filter,
+			lo_temp = utils_map(temp_lim,
 					backup.config.temp_lim_start,
 					backup.config.temp_lim_end,
 					1.0, 0.0);
 		}
 
+		if (lo_temp < 1.0 && !temp_limited) {
+			capture_trigger(CAPTURE_TRIG_TEMP);
+		}
+		temp_limited = lo_temp < 1.0;
+
 		if (lo_temp < 0.9) {
 			LED_ON(LINE_LED_RED);
 		} else {
@@ -155,6 +213,9 @@ static THD_FUNCTION(resistor_thread, arg) {
 					1.0, 0.0);
 		}
 
+		m_lo_temp = lo_temp;
+		m_lo_volts = lo_volts;
+		m_ff_current = ff_regen_current();
 		m_pwm_max = utils_min_abs(lo_temp, lo_volts);
 
 		if (m_pwm_now > m_pwm_max) {
@@ -166,36 +227,95 @@ static THD_FUNCTION(resistor_thread, arg) {
 			resistor_set_pwm(0.0);
 		}
 
-		// Automatic control
-		if (backup.config.load_volt_max_fraction > 0.02) {
-			float auto_ctrl = -1.0;
-			if (volts < backup.config.load_volt_start) {
-				auto_ctrl = -1.0;
-			} else if (volts > backup.config.load_volt_max) {
-				auto_ctrl = backup.config.load_volt_max_fraction;
-			} else {
-				auto_ctrl = utils_map(volts,
-						backup.config.load_volt_start,
-						backup.config.load_volt_max,
-						0.0, backup.config.load_volt_max_fraction);
-			}
-
-			if (auto_ctrl > 0.0) {
-				resistor_set_pwm(auto_ctrl);
-			}
-		}
-
 		chThdSleepMilliseconds(1);
 	}
 }
 
+/**
+ * Set the duty cycle from a thread. The automatic load control writes the
+ * duty cycle from the ADC interrupt, so this is done in a critical section
+ * to keep the compare value, the duty cycle and the set time consistent.
+ *
+ * @param pwm
+ * The duty cycle, 0.0 to 1.0.
+ */
 void resistor_set_pwm(float pwm) {
+	chSysLock();
+	set_duty(pwm);
+	LL_TIM_GenerateEvent_UPDATE(TIM1);
+	chSysUnlock();
+}
+
+float resistor_get_current_filtered(void) {
+	return m_curr_filter;
+}
+
+/**
+ * Get the estimated temperature of the resistor element from the thermal
+ * model.
+ *
+ * @return
+ * The estimated element temperature in degrees C.
+ */
+float resistor_get_temp_est(void) {
+	return m_tmod_t_element;
+}
+
+/**
+ * Get the regenerative input current of the motor controllers used for
+ * feed-forward.
+ *
+ * @return
+ * The summed regenerative current in A, 0 when feed-forward is disabled.
+ */
+float resistor_get_ff_current(void) {
+	return m_ff_current;
+}
+
+float resistor_get_duty(void) {
+	return m_pwm_now;
+}
+
+/**
+ * Get the highest duty cycle that the limits currently allow.
+ *
+ * @return
+ * The duty cycle limit, 0.0 to 1.0.
+ */
+float resistor_get_duty_max(void) {
+	return m_pwm_max;
+}
+
+/**
+ * Get the limit factors from temperature and input voltage derating, where
+ * 1.0 means that the limit is not active.
+ *
+ * @param lo_temp
+ * The temperature limit factor.
+ *
+ * @param lo_volts
+ * The input voltage limit factor.
+ */
+void resistor_get_limits(float *lo_temp, float *lo_volts) {
+	*lo_temp = m_lo_temp;
+	*lo_volts = m_lo_volts;
+}
+
+/*
+ * Update the compare value without forcing an update event. The new duty
+ * cycle takes effect at the next counter peak or valley. Has to be called
+ * from the ADC interrupt or with the system locked.
+ */
+static void set_duty(float pwm) {
+	if (pwm > m_pwm_max) {
+		capture_trigger(CAPTURE_TRIG_CLAMP);
+	}
+
 	utils_truncate_number(&pwm, 0.0, m_pwm_max);
 	m_pwm_now = pwm;
 
 	uint32_t val = (uint32_t)((float)LL_TIM_GetAutoReload(TIM1) * pwm);
 	LL_TIM_OC_SetCompareCH1(TIM1, val);
-	LL_TIM_GenerateEvent_UPDATE(TIM1);
 	m_resistor_set_time = chVTGetSystemTimeX();
 
 	if (m_pwm_now > 0.001) {
@@ -205,8 +325,175 @@ void resistor_set_pwm(float pwm) {
 	}
 }
 
-float resistor_get_current_filtered(void) {
-	return m_curr_filter;
+/*
+ * Automatic load control. This runs in the ADC interrupt for every new
+ * voltage sample, so that the load is applied within one sample period
+ * when the input voltage rises. The thread only updates the limits.
+ */
+static void fast_ctrl(float v_in, float i_in) {
+	// The system tick is too coarse for the sample rate, so measure the
+	// time step with the cycle counter instead.
+	rtcnt_t cnt = chSysGetRealtimeCounterX();
+	float dt = (float)(rtcnt_t)(cnt - m_fast_ctrl_last_cnt) / (float)SystemCoreClock;
+	m_fast_ctrl_last_cnt = cnt;
+
+	// There is no previous sample on the first call
+	if (dt > 0.01) {
+		dt = 0.0;
+	}
+
+	energy_sample(v_in, i_in, m_pwm_now, dt);
+	telemetry_sample(v_in, i_in, m_pwm_now);
+	capture_sample(v_in, i_in, m_pwm_now);
+
+	if (backup.config.load_volt_max_fraction <= 0.02) {
+		m_pi_integral = 0.0;
+		return;
+	}
+
+	float ff = ctrl_ff(v_in);
+
+	switch (backup.config.load_ctrl_mode) {
+	case LOAD_CTRL_MODE_LINEAR: {
+		m_pi_integral = 0.0;
+		float auto_ctrl = ctrl_linear(v_in);
+		if (ff > 0.0) {
+			if (auto_ctrl < 0.0) {
+				auto_ctrl = 0.0;
+			}
+			auto_ctrl += ff;
+		}
+
+		// As in the PI mode, write the zero back once when the output
+		// returns to zero. Otherwise the last feed-forward duty cycle stays
+		// on until the timeout and drains the battery.
+		if (auto_ctrl > 0.0 || m_auto_active) {
+			set_duty(auto_ctrl);
+		}
+		m_auto_active = auto_ctrl > 0.0;
+	} break;
+
+	case LOAD_CTRL_MODE_PI: {
+		float auto_ctrl = ctrl_pi(v_in, dt, ff);
+
+		// Hand the output back to manual control once the regulator
+		// has returned to zero.
+		if (auto_ctrl > 0.0 || m_auto_active) {
+			set_duty(auto_ctrl);
+		}
+		m_auto_active = auto_ctrl > 0.0;
+	} break;
+
+	default:
+		break;
+	}
+}
+
+static float ctrl_linear(float v_in) {
+	return load_ctrl_linear(v_in,
+			backup.config.load_volt_start,
+			backup.config.load_volt_max,
+			backup.config.load_volt_max_fraction);
+}
+
+/*
+ * Regulate the input voltage to load_volt_start. The output is limited to
+ * load_volt_max_fraction and the temperature/voltage limit.
+ */
+static float ctrl_pi(float v_in, float dt, float ff) {
+	float out_max = backup.config.load_volt_max_fraction;
+	if (m_pwm_max < out_max) {
+		out_max = m_pwm_max;
+	}
+
+	return load_ctrl_pi(&m_pi_integral, v_in,
+			backup.config.load_volt_start,
+			backup.config.load_pi_kp,
+			backup.config.load_pi_ki,
+			dt, ff, out_max);
+}
+
+static float ctrl_ff(float v_in) {
+	if (!backup.config.ff_en) {
+		return 0.0;
+	}
+
+	return load_ctrl_ff(m_ff_current, v_in,
+			backup.config.load_res, backup.config.ff_gain);
+}
+
+/*
+ * Sum of the regenerative input currents of the selected motor controllers,
+ * from their latest fresh CAN_PACKET_STATUS_4.
+ */
+static float ff_regen_current(void) {
+	if (!backup.config.ff_en) {
+		return 0.0;
+	}
+
+	float i_regen = 0.0;
+	float timeout = (float)backup.config.ff_timeout_ms / 1000.0;
+
+	for (int id = backup.config.ff_id_first;id <= backup.config.ff_id_last;id++) {
+		can_status_msg_4 *msg = comm_can_get_status_msg_4_id(id);
+
+		if (msg && msg->current_in < 0.0 && UTILS_AGE_S(msg->rx_time) < timeout) {
+			i_regen -= msg->current_in;
+		}
+	}
+
+	return i_regen;
+}
+
+/*
+ * Lumped thermal model. The element is heated by the dissipated power and
+ * cools to the heatsink, which in turn cools to ambient. Ambient is taken
+ * as the measured temperature at boot, and the heatsink estimate is slowly
+ * pulled towards the measured temperature so that parameter errors do not
+ * accumulate.
+ */
+static void tmod_update(float dt) {
+	// Start from the filtered temperature once it has settled on real
+	// samples, and use the sensors directly until then.
+	if (!m_tmod_init_done) {
+		m_tmod_settle_time += dt;
+		m_tmod_t_element = m_temp_max_filter;
+
+		if (m_tmod_settle_time >= TMOD_SETTLE_S) {
+			m_tmod_t_amb = m_temp_max_filter;
+			m_tmod_t_hs = m_temp_max_filter;
+			m_tmod_init_done = true;
+		}
+		return;
+	}
+
+	// The heatsink is never colder than ambient, so ambient follows it down
+	// right away. That corrects a start from a warm heatsink as it cools.
+	// Rises are followed slowly, as the heatsink is mostly warmer than
+	// ambient because of the load.
+	if (m_temp_max_filter < m_tmod_t_amb) {
+		m_tmod_t_amb = m_temp_max_filter;
+	} else {
+		UTILS_LP_FAST(m_tmod_t_amb, m_temp_max_filter, dt / TMOD_AMB_TAU);
+	}
+
+	const volatile main_config_t *conf = &backup.config;
+
+	if (conf->load_res <= 0.0 || conf->tmod_c_element <= 0.0 || conf->tmod_r_element <= 0.0 ||
+			conf->tmod_c_hs <= 0.0 || conf->tmod_r_hs <= 0.0) {
+		m_tmod_t_element = m_temp_max_filter;
+		return;
+	}
+
+	float v_in = pwr_get_vin();
+	float p_in = v_in * v_in * m_pwm_now / conf->load_res;
+	float p_element_hs = (m_tmod_t_element - m_tmod_t_hs) / conf->tmod_r_element;
+	float p_hs_amb = (m_tmod_t_hs - m_tmod_t_amb) / conf->tmod_r_hs;
+
+	m_tmod_t_element += (p_in - p_element_hs) * dt / conf->tmod_c_element;
+	m_tmod_t_hs += (p_element_hs - p_hs_amb) * dt / conf->tmod_c_hs;
+
+	UTILS_LP_FAST(m_tmod_t_hs, m_temp_max_filter, dt / TMOD_HS_TAU);
 }
 
 static void terminal_pwm(int argc, const char **argv) {
@@ -24,5 +24,10 @@
 void resistor_init(void);
 void resistor_set_pwm(float pwm);
 float resistor_get_current_filtered(void);
+float resistor_get_temp_est(void);
+float resistor_get_duty(void);
+float resistor_get_duty_max(void);
+void resistor_get_limits(float *lo_temp, float *lo_volts);
+float resistor_get_ff_current(void);
 
 #endif /* RESISTOR_H_ */
@@ -0,0 +1,245 @@
+/*
+	Copyright 2021 - 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC Braking Resistor firmware.
+
+	The VESC Braking Resistor firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC Braking Resistor firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "ch.h"
+#include "hal.h"
+#include "telemetry.h"
+#include "datatypes.h"
+#include "buffer.h"
+#include "packet.h"
+#include "comm_usb.h"
+#include "commands.h"
+#include "terminal.h"
+#include "utils.h"
+#include "pwr.h"
+#include <stdlib.h>
+
+/*
+ * Binary telemetry streaming over USB. Every sample from the ADC callback,
+ * or every n:th sample with decimation, is written to a single-producer
+ * single-consumer ring buffer from the interrupt. The thread drains the
+ * buffer and sends the samples in batches as COMM_RES_TELEMETRY packets:
+ *
+ * uint8  COMM_RES_TELEMETRY
+ * uint32 Index of the first sample in the packet
+ * uint32 Samples dropped because the buffer was full
+ * uint16 Decimation
+ * uint8  Number of samples
+ *
+ * Followed by the samples:
+ *
+ * uint16 Timestamp in microseconds, wrapping
+ * int16  Input voltage * 100
+ * int16  Input current * 100
+ * uint16 Duty cycle * 10000
+ * int16  Temperatures * 10, TELEMETRY_TEMPS times
+ *
+ * The temperatures are filtered by the NTCs anyway, so they are updated by
+ * the thread on every batch rather than converted in the interrupt.
+ */
+
+// Settings
+#define BUFFER_LEN				512 // Must be a power of two
+#define SAMPLES_PER_PACKET		32
+#define TELEMETRY_TEMPS			3 // Center, MOS and PCB
+#define DECIMATION_MAX			500 // Limited by the 16-bit timestamp
+#define THREAD_SLEEP_MS			5
+
+typedef struct {
+	uint16_t time_us;
+	int16_t v_in;
+	int16_t i_in;
+	uint16_t duty;
+	int16_t temps[TELEMETRY_TEMPS];
+} telemetry_sample_t;
+
+// Threads
+static THD_WORKING_AREA(telemetry_thread_wa, 1024);
+static THD_FUNCTION(telemetry_thread, arg);
+
+// Private functions
+static void terminal_start(int argc, const char **argv);
+static void terminal_stop(int argc, const char **argv);
+
+// Private variables
+static telemetry_sample_t m_buffer[BUFFER_LEN];
+static volatile uint32_t m_write = 0;
+static volatile uint32_t m_read = 0;
+static volatile uint32_t m_dropped = 0;
+static volatile bool m_running = false;
+static volatile bool m_start_req = false;
+static volatile int m_decimation = 1;
+static int m_decimation_cnt = 0;
+static volatile int16_t m_temps[TELEMETRY_TEMPS];
+static uint8_t m_send_buffer[PACKET_MAX_PL_LEN];
+
+void telemetry_init(void) {
+	chThdCreateStatic(telemetry_thread_wa, sizeof(telemetry_thread_wa), NORMALPRIO - 1, telemetry_thread, NULL);
+
+	terminal_register_command_callback(
+			"tlm_start",
+			"Start streaming binary telemetry over USB",
+			"[decimation]",
+			terminal_start);
+
+	terminal_register_command_callback(
+			"tlm_stop",
+			"Stop streaming telemetry",
+			0,
+			terminal_stop);
+}
+
+/**
+ * Record a sample. Called from the ADC interrupt.
+ *
+ * @param v_in
+ * Input voltage.
+ *
+ * @param i_in
+ * Input current.
+ *
+ * @param duty
+ * Duty cycle applied to the load.
+ */
+void telemetry_sample(float v_in, float i_in, float duty) {
+	if (!m_running) {
+		return;
+	}
+
+	m_decimation_cnt++;
+	if (m_decimation_cnt < m_decimation) {
+		return;
+	}
+	m_decimation_cnt = 0;
+
+	uint32_t write = m_write;
+	if ((write - m_read) >= BUFFER_LEN) {
+		m_dropped++;
+		return;
+	}
+
+	telemetry_sample_t *s = &m_buffer[write & (BUFFER_LEN - 1)];
+	s->time_us = (uint16_t)(chSysGetRealtimeCounterX() / (SystemCoreClock / 1000000));
+	s->v_in = (int16_t)(v_in * 1e2);
+	s->i_in = (int16_t)(i_in * 1e2);
+	s->duty = (uint16_t)(duty * 1e4);
+	for (int i = 0;i < TELEMETRY_TEMPS;i++) {
+		s->temps[i] = m_temps[i];
+	}
+
+	// Make sure that the sample is written before it is published
+	__DMB();
+	m_write = write + 1;
+}
+
+/**
+ * Start streaming. Samples that are still in the buffer from a previous run
+ * are discarded. The buffer is reset by the thread, as it is the only reader.
+ *
+ * @param decimation
+ * Record every decimation:th sample. Truncated to 1 - 500.
+ */
+void telemetry_start(int decimation) {
+	utils_truncate_number_int(&decimation, 1, DECIMATION_MAX);
+
+	m_running = false;
+	m_decimation = decimation;
+	m_start_req = true;
+}
+
+void telemetry_stop(void) {
+	m_running = false;
+}
+
+bool telemetry_is_running(void) {
+	return m_running || m_start_req;
+}
+
+static THD_FUNCTION(telemetry_thread, arg) {
+	(void)arg;
+
+	chRegSetThreadName("Telemetry");
+
+	for (;;) {
+		if (m_start_req) {
+			m_read = m_write;
+			m_dropped = 0;
+			m_start_req = false;
+			m_running = true;
+		}
+
+		for (int i = 0;i < TELEMETRY_TEMPS;i++) {
+			m_temps[i] = (int16_t)(pwr_get_temp(i) * 1e1);
+		}
+
+		while (m_read != m_write) {
+			uint32_t read = m_read;
+			uint32_t num = m_write - read;
+			if (num > SAMPLES_PER_PACKET) {
+				num = SAMPLES_PER_PACKET;
+			}
+
+			int32_t ind = 0;
+			m_send_buffer[ind++] = COMM_RES_TELEMETRY;
+			buffer_append_uint32(m_send_buffer, read, &ind);
+			buffer_append_uint32(m_send_buffer, m_dropped, &ind);
+			buffer_append_uint16(m_send_buffer, m_decimation, &ind);
+			m_send_buffer[ind++] = num;
+
+			for (uint32_t i = 0;i < num;i++) {
+				telemetry_sample_t *s = &m_buffer[(read + i) & (BUFFER_LEN - 1)];
+				buffer_append_uint16(m_send_buffer, s->time_us, &ind);
+				buffer_append_int16(m_send_buffer, s->v_in, &ind);
+				buffer_append_int16(m_send_buffer, s->i_in, &ind);
+				buffer_append_uint16(m_send_buffer, s->duty, &ind);
+				for (int j = 0;j < TELEMETRY_TEMPS;j++) {
+					buffer_append_int16(m_send_buffer, s->temps[j], &ind);
+				}
+			}
+
+			// Done reading the samples before handing the slots back
+			__DMB();
+			m_read = read + num;
+
+#if HAL_USE_USB
+			comm_usb_send_packet(m_send_buffer, ind);
+#endif
+		}
+
+		chThdSleepMilliseconds(THREAD_SLEEP_MS);
+	}
+}
+
+static void terminal_start(int argc, const char **argv) {
+	int decimation = 1;
+	if (argc == 2) {
+		decimation = atoi(argv[1]);
+	}
+
+	telemetry_start(decimation);
+	commands_printf("Telemetry started with decimation %d\n", m_decimation);
+}
+
+static void terminal_stop(int argc, const char **argv) {
+	(void)argc;
+	(void)argv;
+
+	telemetry_stop();
+	commands_printf("Telemetry stopped, %lu samples dropped\n", (unsigned long)m_dropped);
+}
@@ -122,10 +122,10 @@ void terminal_process_string(char *str) {
 		}
 	} else if (strcmp(argv[0], "can_devs") == 0) {
 		commands_printf("CAN devices seen on the bus the past second:\n");
-		for (int i = 0;i < CAN_STATUS_MSGS_TO_STORE;i++) {
-			can_status_msg *msg = comm_can_get_status_msg_index(i);
+		for (int id = comm_can_node_next(-1);id >= 0;id = comm_can_node_next(id)) {
+			can_status_msg *msg = comm_can_get_status_msg_id(id);
 
-			if (msg->id >= 0 && UTILS_AGE_S(msg->rx_time) < 1.0) {
+			if (msg && UTILS_AGE_S(msg->rx_time) < 1.0) {
 				commands_printf("ID                 : %i", msg->id);
 				commands_printf("RX Time            : %i", msg->rx_time);
 				commands_printf("Age (milliseconds) : %.2f", (double)(UTILS_AGE_S(msg->rx_time) * 1000.0));
@@ -136,10 +136,10 @@ void terminal_process_string(char *str) {
 		}
 
 		commands_printf("BMS devices seen on the bus the past second:\n");
-		for (int i = 0;i < CAN_BMS_STATUS_MSGS_TO_STORE;i++) {
-			bms_soc_soh_temp_stat *msg = comm_can_get_bms_soc_soh_temp_stat_index(i);
+		for (int id = comm_can_node_next(-1);id >= 0;id = comm_can_node_next(id)) {
+			bms_soc_soh_temp_stat *msg = comm_can_get_bms_soc_soh_temp_stat_id(id);
 
-			if (msg->id >= 0 && UTILS_AGE_S(msg->rx_time) < 1.0) {
+			if (msg && UTILS_AGE_S(msg->rx_time) < 1.0) {
 				commands_printf("ID                 : %i", msg->id);
 				commands_printf("RX Time            : %i", msg->rx_time);
 				commands_printf("Age (milliseconds) : %.2f", (double)(UTILS_AGE_S(msg->rx_time) * 1000.0));
@@ -177,22 +177,78 @@ void terminal_process_string(char *str) {
 
 		commands_printf(" ");
 	} else if (strcmp(argv[0], "can_scan") == 0) {
-		bool found = false;
-		for (int i = 0;i < 254;i++) {
-			HW_TYPE hw_type;
-			if (comm_can_ping(i, &hw_type)) {
-				commands_printf("Found %s with ID: %d", utils_hw_type_to_string(hw_type), i);
-				found = true;
-			}
+		static uint8_t ids[255];
+		static HW_TYPE hw_types[255];
+		int num = comm_can_scan(ids, hw_types, 255);
+
+		for (int i = 0;i < num;i++) {
+			commands_printf("Found %s with ID: %d", utils_hw_type_to_string(hw_types[i]), ids[i]);
 		}
 
-		if (found) {
+		if (num > 0) {
 			commands_printf("Done\n");
 		} else {
 			commands_printf("No CAN devices found\n");
 		}
 	} else if (strcmp(argv[0], "uptime") == 0) {
 		commands_printf("Uptime: %.2f s", (double)chVTGetSystemTimeX() / (double)CH_CFG_ST_FREQUENCY);
+	} else if (strcmp(argv[0], "can_stats") == 0) {
+		if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+			comm_can_reset_stats();
+			commands_printf("CAN statistics reset\n");
+			return;
+		}
+
+		can_stats stats;
+		comm_can_get_stats(&stats);
+		commands_printf("RX frames    : %lu (%.1f/s)", (unsigned long)stats.rx_frames, (double)stats.rx_rate);
+		commands_printf("RX dropped   : %lu", (unsigned long)stats.rx_dropped);
+		commands_printf("RX overruns  : %lu", (unsigned long)stats.rx_overruns);
+		commands_printf("RX queue max : %lu", (unsigned long)stats.rx_queue_max);
+		commands_printf("TX frames    : %lu (%.1f/s)", (unsigned long)stats.tx_frames, (double)stats.tx_rate);
+		commands_printf("TX stalls    : %lu", (unsigned long)stats.tx_bulk_stalls);
+		commands_printf("Bus load     : %.1f %%", (double)(stats.bus_load * 100.0));
+		commands_printf("Errors       : warning %lu, passive %lu, bus off %lu, framing %lu",
+				(unsigned long)stats.err_warning, (unsigned long)stats.err_passive,
+				(unsigned long)stats.err_bus_off, (unsigned long)stats.err_framing);
+		commands_printf("TEC / REC    : %d / %d", stats.tec, stats.rec);
+
+		const char *prio_names[CAN_TX_PRIO_NUM] = {"High", "Normal", "Bulk"};
+		for (int i = 0;i < CAN_TX_PRIO_NUM;i++) {
+			commands_printf("TX %-9s : dropped %lu, queue max %lu, latency avg %lu us, max %lu us", prio_names[i],
+					(unsigned long)stats.tx_dropped[i],
+					(unsigned long)stats.tx_queue_max[i],
+					(unsigned long)stats.tx_latency_avg_us[i],
+					(unsigned long)stats.tx_latency_max_us[i]);
+		}
+
+		const uint32_t lat_limits[CAN_TX_LAT_BINS] = CAN_TX_LAT_BIN_LIMITS_US;
+		commands_printf("TX latency histogram:");
+		for (int i = 0;i < CAN_TX_LAT_BINS;i++) {
+			if (i == (CAN_TX_LAT_BINS - 1)) {
+				commands_printf("  >= %5lu us : %lu", (unsigned long)lat_limits[i - 1],
+						(unsigned long)stats.tx_latency_hist[i]);
+			} else {
+				commands_printf("  <  %5lu us : %lu", (unsigned long)lat_limits[i],
+						(unsigned long)stats.tx_latency_hist[i]);
+			}
+		}
+
+		static uint32_t counts[CAN_RX_TYPES];
+		comm_can_get_rx_type_counts(counts);
+		commands_printf("RX frames by packet type:");
+		for (int i = 0;i < CAN_RX_TYPES;i++) {
+			if (counts[i] == 0) {
+				continue;
+			}
+
+			if (i == (CAN_RX_TYPES - 1)) {
+				commands_printf("  other : %lu", (unsigned long)counts[i]);
+			} else {
+				commands_printf("  %5d : %lu", i, (unsigned long)counts[i]);
+			}
+		}
+		commands_printf(" ");
 	}
 
 	// The help command
@@ -228,6 +284,9 @@ void terminal_process_string(char *str) {
 		commands_printf("uptime");
 		commands_printf("  Prints how many seconds have passed since boot.");
 
+		commands_printf("can_stats [reset]");
+		commands_printf("  Prints CAN traffic, queue and error statistics, or resets them.");
+
 		for (int i = 0;i < callback_write;i++) {
 			if (callbacks[i].cbf == 0) {
 				continue;
@@ -0,0 +1,522 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Host throughput harness of the acknowledged CAN bulk transfer. A sender and
+ * a receiver node exchange 512 byte buffers over a simulated 500 kbit/s bus,
+ * with the window and ack handling of can_bulk.c on both ends and the start
+ * handshake, timeouts and fallbacks as in comm_can.c. Frames are lost at the
+ * receiving node with a fixed probability, as when its RX FIFO overflows. An
+ * optional background node sends higher priority frames, like the status
+ * messages of motor controllers.
+ *
+ * The same buffers are sent with the fill frames of comm_can_send_buffer for
+ * comparison. They are not acknowledged, so a lost frame loses the buffer, and
+ * the host sends it again after HOST_TIMEOUT_MS. A failed bulk transfer is
+ * retried the same way.
+ */
+
+#include "can_bulk.h"
+#include "crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Simulation
+#define BITRATE				500000.0
+#define ACK_TIMEOUT_US		10000.0 // CAN_BULK_ACK_TIMEOUT_MS
+#define RX_LATENCY_US		200.0 // From reception until the process thread has sent a reply
+#define HOST_TIMEOUT_MS		200.0
+#define CHUNKS				50
+#define CHUNK_LEN			512
+#define ATTEMPTS_MAX		50
+#define QUEUE_SIZE			256
+
+// CAN IDs
+#define ID_SENDER			1
+#define ID_RECEIVER			2
+#define CMD_FILL			5 // CAN_PACKET_FILL_RX_BUFFER
+#define CMD_FILL_LONG		6 // CAN_PACKET_FILL_RX_BUFFER_LONG
+#define CMD_PROCESS			7 // CAN_PACKET_PROCESS_RX_BUFFER
+#define CMD_STATUS			9 // CAN_PACKET_STATUS
+#define CMD_BULK_START		201
+#define CMD_BULK_DATA		202
+#define CMD_BULK_ACK		203
+
+// Private types
+typedef enum {
+	NODE_SENDER = 0,
+	NODE_RECEIVER,
+	NODE_BACKGROUND,
+	NODE_NUM
+} node;
+
+typedef struct {
+	uint32_t eid;
+	uint8_t dlc;
+	uint8_t data[8];
+	double ready;
+} frame;
+
+typedef struct {
+	frame frames[QUEUE_SIZE];
+	int read;
+	int write;
+} queue;
+
+typedef enum {
+	SEND_IDLE = 0,
+	SEND_START, // Waiting for the answer to the start frame
+	SEND_DATA, // Waiting for an ack
+	SEND_LEGACY, // Waiting for the receiver to process the fill frames
+	SEND_DONE,
+	SEND_FAILED
+} send_state;
+
+typedef struct {
+	double loss;
+	double bg_load;
+	bool bulk;
+} scenario;
+
+typedef struct {
+	double time;
+	int host_retries;
+	int fallbacks;
+	int frames;
+	int stalled;
+	int corrupt;
+} result;
+
+// Private variables
+static queue m_queues[NODE_NUM];
+static double m_now;
+static double m_bus_free;
+static double m_bg_next;
+static const scenario *m_scen;
+static uint8_t m_chunk[CHUNK_LEN];
+
+// Sender
+static send_state m_send_state;
+static double m_deadline;
+static int m_start_tries;
+static can_bulk_tx m_tx;
+static bool m_legacy_lost;
+static int m_frames;
+
+// Receiver
+static can_bulk_rx m_rx;
+static unsigned short m_rx_crc;
+static bool m_rx_bulk_active;
+static bool m_rx_done;
+static bool m_rx_corrupt;
+
+static double frame_time_us(int dlc) {
+	// Same estimate as frame_bits in comm_can.c
+	double bits = 67 + 8 * dlc;
+	return (bits + (int)bits / 10) / BITRATE * 1e6;
+}
+
+static double rand_uniform(void) {
+	return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static void queue_push(node n, uint32_t eid, const uint8_t *data, int len, double ready) {
+	queue *q = &m_queues[n];
+	frame *f = &q->frames[q->write++ % QUEUE_SIZE];
+	f->eid = eid;
+	f->dlc = len;
+	memcpy(f->data, data, len);
+	f->ready = ready;
+
+	if (n == NODE_SENDER) {
+		m_frames++;
+	}
+}
+
+static void bulk_send(void *arg, int seq, bool ack_req) {
+	(void)arg;
+	uint8_t buffer[8];
+	unsigned int offset = seq * 6;
+	unsigned int send_len = (CHUNK_LEN - offset) < 6 ? (CHUNK_LEN - offset) : 6;
+
+	buffer[0] = ID_SENDER;
+	buffer[1] = seq | (ack_req ? CAN_BULK_SEQ_ACK_REQ : 0);
+	memcpy(buffer + 2, m_chunk + offset, send_len);
+	queue_push(NODE_SENDER, ID_RECEIVER | (CMD_BULK_DATA << 8), buffer, send_len + 2, m_now);
+}
+
+static void send_start(void) {
+	uint8_t buffer[6];
+	unsigned short crc = crc16(m_chunk, CHUNK_LEN);
+	buffer[0] = ID_SENDER;
+	buffer[1] = 0;
+	buffer[2] = CHUNK_LEN >> 8;
+	buffer[3] = CHUNK_LEN & 0xFF;
+	buffer[4] = crc >> 8;
+	buffer[5] = crc & 0xFF;
+	queue_push(NODE_SENDER, ID_RECEIVER | (CMD_BULK_START << 8), buffer, 6, m_now);
+	m_deadline = m_now + ACK_TIMEOUT_US;
+}
+
+/*
+ * Same frames as comm_can_send_buffer without bulk support
+ */
+static void send_legacy(void) {
+	uint8_t buffer[8];
+	unsigned int end_a = 0;
+
+	for (unsigned int i = 0;i < CHUNK_LEN && i <= 255;i += 7) {
+		unsigned int send_len = (CHUNK_LEN - i) < 7 ? (CHUNK_LEN - i) : 7;
+		buffer[0] = i;
+		memcpy(buffer + 1, m_chunk + i, send_len);
+		queue_push(NODE_SENDER, ID_RECEIVER | (CMD_FILL << 8), buffer, send_len + 1, m_now);
+		end_a = i + 7;
+	}
+
+	for (unsigned int i = end_a;i < CHUNK_LEN;i += 6) {
+		unsigned int send_len = (CHUNK_LEN - i) < 6 ? (CHUNK_LEN - i) : 6;
+		buffer[0] = i >> 8;
+		buffer[1] = i & 0xFF;
+		memcpy(buffer + 2, m_chunk + i, send_len);
+		queue_push(NODE_SENDER, ID_RECEIVER | (CMD_FILL_LONG << 8), buffer, send_len + 2, m_now);
+	}
+
+	memset(buffer, 0, 6);
+	queue_push(NODE_SENDER, ID_RECEIVER | (CMD_PROCESS << 8), buffer, 6, m_now);
+
+	m_legacy_lost = false;
+	m_send_state = SEND_LEGACY;
+}
+
+static void sender_ack(const frame *f) {
+	if (f->dlc < CAN_BULK_ACK_LEN) {
+		return;
+	}
+
+	if (m_send_state == SEND_START) {
+		if (f->data[1] == CAN_BULK_STATUS_RUNNING && f->data[2] == 0) {
+			can_bulk_tx_init(&m_tx, CHUNK_LEN, bulk_send, 0);
+			can_bulk_tx_send_window(&m_tx);
+			m_send_state = SEND_DATA;
+			m_deadline = m_now + ACK_TIMEOUT_US;
+		}
+	} else if (m_send_state == SEND_DATA) {
+		CAN_BULK_TX_RES res = can_bulk_tx_ack(&m_tx, f->data);
+
+		if (res == CAN_BULK_TX_RUNNING) {
+			can_bulk_tx_send_window(&m_tx);
+			m_deadline = m_now + ACK_TIMEOUT_US;
+		} else {
+			m_send_state = res == CAN_BULK_TX_DONE ? SEND_DONE : SEND_FAILED;
+		}
+	}
+}
+
+static void sender_timeout(void) {
+	if (m_send_state == SEND_START) {
+		if (++m_start_tries > CAN_BULK_RETRIES) {
+			// The receiver looks like it has no bulk support
+			send_legacy();
+		} else {
+			send_start();
+		}
+	} else if (m_send_state == SEND_DATA) {
+		if (can_bulk_tx_timeout(&m_tx) == CAN_BULK_TX_RUNNING) {
+			can_bulk_tx_send_window(&m_tx);
+			m_deadline = m_now + ACK_TIMEOUT_US;
+		} else {
+			m_send_state = SEND_FAILED;
+		}
+	}
+}
+
+static void receiver_ack(int trigger) {
+	uint8_t buffer[CAN_BULK_ACK_LEN];
+	int32_t ind = 0;
+	buffer[ind++] = ID_RECEIVER;
+	can_bulk_rx_ack(&m_rx, trigger, buffer, &ind);
+	queue_push(NODE_RECEIVER, ID_SENDER | (CMD_BULK_ACK << 8), buffer, ind, m_now + RX_LATENCY_US);
+}
+
+static void receiver_frame(const frame *f) {
+	int cmd = f->eid >> 8;
+
+	if (cmd == CMD_BULK_START) {
+		unsigned int len = (unsigned int)f->data[2] << 8 | f->data[3];
+		m_rx_crc = (unsigned short)f->data[4] << 8 | f->data[5];
+		can_bulk_rx_init(&m_rx, len);
+		m_rx_bulk_active = true;
+		receiver_ack(0);
+	} else if (cmd == CMD_BULK_DATA && m_rx_bulk_active) {
+		int seq = f->data[1] & ~CAN_BULK_SEQ_ACK_REQ;
+		bool ack_req = f->data[1] & CAN_BULK_SEQ_ACK_REQ;
+
+		switch (can_bulk_rx_data(&m_rx, seq, f->data + 2, f->dlc - 2)) {
+		case CAN_BULK_RX_COMPLETE:
+			m_rx.status = crc16(m_rx.buf, m_rx.len) == m_rx_crc ?
+					CAN_BULK_STATUS_DONE : CAN_BULK_STATUS_ERROR;
+			receiver_ack(seq);
+			if (m_rx.status == CAN_BULK_STATUS_DONE) {
+				m_rx_done = true;
+				m_rx_corrupt = memcmp(m_rx.buf, m_chunk, CHUNK_LEN) != 0;
+			}
+			break;
+
+		case CAN_BULK_RX_STORED:
+		case CAN_BULK_RX_FINISHED:
+			if (ack_req) {
+				receiver_ack(seq);
+			}
+			break;
+
+		default:
+			break;
+		}
+	} else if (cmd == CMD_PROCESS && m_send_state == SEND_LEGACY) {
+		// The fill frames have to arrive in order, so any lost frame loses
+		// the buffer
+		if (!m_legacy_lost) {
+			m_rx_done = true;
+			m_send_state = SEND_DONE;
+		} else {
+			m_send_state = SEND_FAILED;
+		}
+	}
+}
+
+/*
+ * Run the bus until the sender has finished with the chunk.
+ */
+static void run_bus(void) {
+	while (m_send_state != SEND_DONE && m_send_state != SEND_FAILED) {
+		if (m_scen->bg_load > 0.0) {
+			queue *q = &m_queues[NODE_BACKGROUND];
+			if (q->read == q->write) {
+				uint8_t data[8] = {0};
+				queue_push(NODE_BACKGROUND, 10 | (CMD_STATUS << 8), data, 8, m_bg_next);
+				m_bg_next += frame_time_us(8) / m_scen->bg_load;
+			}
+		}
+
+		// Arbitration between the frames that are ready when the bus is free
+		double t_bus = m_now > m_bus_free ? m_now : m_bus_free;
+		double t_ready = 1e30;
+		for (int n = 0;n < NODE_NUM;n++) {
+			queue *q = &m_queues[n];
+			if (q->read != q->write && q->frames[q->read % QUEUE_SIZE].ready < t_ready) {
+				t_ready = q->frames[q->read % QUEUE_SIZE].ready;
+			}
+		}
+
+		double t_start = t_ready > t_bus ? t_ready : t_bus;
+		bool waiting = m_send_state == SEND_START || m_send_state == SEND_DATA;
+
+		if (waiting && m_deadline <= t_start) {
+			m_now = m_deadline;
+			sender_timeout();
+			continue;
+		}
+
+		int winner = -1;
+		for (int n = 0;n < NODE_NUM;n++) {
+			queue *q = &m_queues[n];
+			if (q->read == q->write || q->frames[q->read % QUEUE_SIZE].ready > t_start) {
+				continue;
+			}
+
+			if (winner < 0 || q->frames[q->read % QUEUE_SIZE].eid <
+					m_queues[winner].frames[m_queues[winner].read % QUEUE_SIZE].eid) {
+				winner = n;
+			}
+		}
+
+		frame f = m_queues[winner].frames[m_queues[winner].read++ % QUEUE_SIZE];
+		double t_end = t_start + frame_time_us(f.dlc);
+
+		// A deadline during the frame is handled before the frame arrives
+		if (waiting && m_deadline < t_end) {
+			m_now = m_deadline;
+			sender_timeout();
+		}
+
+		m_now = t_end;
+		m_bus_free = t_end;
+
+		bool lost = rand_uniform() < m_scen->loss;
+		int dest = f.eid & 0xFF;
+
+		if (winner == NODE_SENDER && lost) {
+			m_legacy_lost = true;
+
+			// Nothing will answer a lost process frame
+			if ((f.eid >> 8) == CMD_PROCESS) {
+				m_send_state = SEND_FAILED;
+			}
+		}
+
+		if (lost || winner == NODE_BACKGROUND) {
+			continue;
+		}
+
+		if (dest == ID_RECEIVER) {
+			receiver_frame(&f);
+		} else if (dest == ID_SENDER && (f.eid >> 8) == CMD_BULK_ACK) {
+			sender_ack(&f);
+		}
+	}
+}
+
+static result run(const scenario *scen) {
+	result res;
+	memset(&res, 0, sizeof(res));
+
+	m_scen = scen;
+	m_now = 0.0;
+	m_bus_free = 0.0;
+	m_bg_next = 0.0;
+	memset(m_queues, 0, sizeof(m_queues));
+	m_frames = 0;
+
+	for (int c = 0;c < CHUNKS;c++) {
+		for (int i = 0;i < CHUNK_LEN;i++) {
+			m_chunk[i] = rand();
+		}
+
+		int attempts = 0;
+		for (;;) {
+			double attempt_start = m_now;
+
+			// Frames left from the previous attempt are dropped by the receiver
+			m_queues[NODE_SENDER].read = m_queues[NODE_SENDER].write;
+			m_queues[NODE_RECEIVER].read = m_queues[NODE_RECEIVER].write;
+			m_rx_bulk_active = false;
+			m_rx_done = false;
+			m_rx_corrupt = false;
+
+			if (scen->bulk) {
+				m_start_tries = 0;
+				m_send_state = SEND_START;
+				send_start();
+			} else {
+				send_legacy();
+			}
+
+			run_bus();
+
+			if (m_start_tries > CAN_BULK_RETRIES) {
+				res.fallbacks++;
+			}
+
+			if (m_send_state == SEND_DONE && m_rx_done) {
+				res.corrupt += m_rx_corrupt;
+				break;
+			}
+
+			res.host_retries++;
+			if (++attempts >= ATTEMPTS_MAX) {
+				res.stalled++;
+				break;
+			}
+
+			double retry = attempt_start + HOST_TIMEOUT_MS * 1000.0;
+			if (m_now < retry) {
+				m_now = retry;
+			}
+
+			// The background frames are not simulated while waiting for the host
+			m_queues[NODE_BACKGROUND].read = m_queues[NODE_BACKGROUND].write;
+			if (m_bg_next < m_now) {
+				m_bg_next = m_now;
+			}
+		}
+	}
+
+	res.time = m_now / 1e6;
+	res.frames = m_frames;
+	return res;
+}
+
+int main(void) {
+	const double losses[] = {0.0, 0.001, 0.01, 0.02, 0.05, 0.1};
+	const double bg_loads[] = {0.0, 0.3};
+	int fails = 0;
+
+	srand(1);
+
+	printf("%d chunks of %d bytes, host timeout %.0f ms\n\n", CHUNKS, CHUNK_LEN, HOST_TIMEOUT_MS);
+	printf("%6s %6s %-7s %10s %8s %8s %9s %8s\n", "loss", "bg", "mode",
+			"kB/s", "frames", "retries", "fallback", "stalled");
+
+	for (unsigned int b = 0;b < sizeof(bg_loads) / sizeof(bg_loads[0]);b++) {
+		for (unsigned int l = 0;l < sizeof(losses) / sizeof(losses[0]);l++) {
+			result res[2];
+
+			for (int bulk = 0;bulk < 2;bulk++) {
+				scenario scen = {losses[l], bg_loads[b], bulk};
+				res[bulk] = run(&scen);
+				result *r = &res[bulk];
+
+				double rate = r->stalled ? 0.0 :
+						(double)(CHUNKS * CHUNK_LEN) / r->time / 1000.0;
+
+				printf("%5.1f%% %5.0f%% %-7s %10.2f %8d %8d %9d %8d\n",
+						losses[l] * 100.0, bg_loads[b] * 100.0, bulk ? "bulk" : "fill",
+						rate, r->frames, r->host_retries, r->fallbacks, r->stalled);
+
+				if (r->corrupt) {
+					printf("FAIL: %d corrupt buffers\n", r->corrupt);
+					fails++;
+				}
+			}
+
+			double t_fill = res[0].stalled ? 1e30 : res[0].time;
+			double t_bulk = res[1].stalled ? 1e30 : res[1].time;
+
+			// The acks cost little without loss, with loss bulk has to win
+			// and must not need the host to send buffers again. With
+			// background traffic, the bulk commands lose the arbitration
+			// against the status messages while the fill commands win it, so
+			// only the loss cases are compared then.
+			if (losses[l] == 0.0 && bg_loads[b] == 0.0 && t_bulk > (t_fill * 1.25)) {
+				printf("FAIL: bulk more than 25 %% slower without loss\n");
+				fails++;
+			}
+
+			if (losses[l] >= 0.01 && t_bulk >= t_fill) {
+				printf("FAIL: bulk not faster with loss\n");
+				fails++;
+			}
+
+			if (losses[l] <= 0.05 && (res[1].host_retries > 0 || res[1].fallbacks > 0)) {
+				printf("FAIL: bulk transfers failed\n");
+				fails++;
+			}
+		}
+	}
+
+	if (fails > 0) {
+		printf("can_bulk: %d failures\n", fails);
+		return 1;
+	}
+
+	printf("can_bulk: OK\n");
+	return 0;
+}
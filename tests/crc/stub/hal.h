@@ -0,0 +1,25 @@
+/*
+ * Minimal hal.h for building crc.c on the host. Only the software CRC16
+ * implementations can run here, crc32 and CRC16_IMPL_HW need the CRC unit.
+ */
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdint.h>
+
+typedef struct {
+	volatile uint32_t DR;
+	volatile uint32_t IDR;
+	volatile uint32_t CR;
+	uint32_t RESERVED;
+	volatile uint32_t INIT;
+	volatile uint32_t POL;
+} CRC_TypeDef;
+
+static CRC_TypeDef crc_stub;
+
+#define CRC				(&crc_stub)
+#define CRC_CR_RESET	(1 << 0)
+
+#endif /* HAL_H_ */
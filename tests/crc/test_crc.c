@@ -0,0 +1,147 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Host conformance test and benchmark of the software CRC16 implementations
+ * in crc.c. The Makefile builds crc.c once with CRC16_IMPL_TABLE and once with
+ * CRC16_IMPL_SLICE4, with the functions renamed so that both can be linked
+ * here, and both are compared with a bitwise CRC16-CCITT (XMODEM) reference.
+ *
+ * test_crc        conformance test only
+ * bench_crc bench conformance test, then throughput of all implementations
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Settings
+#define ITERATIONS			100000
+#define LEN_MAX				600
+#define BENCH_LEN			512
+#define BENCH_BYTES			(256 * 1024 * 1024)
+
+// crc.c built with CRC16_IMPL_TABLE and CRC16_IMPL_SLICE4
+unsigned short crc16_table(unsigned char *buf, unsigned int len);
+unsigned short crc16_update_table(unsigned short crc, const unsigned char *buf, unsigned int len);
+unsigned short crc16_slice4(unsigned char *buf, unsigned int len);
+unsigned short crc16_update_slice4(unsigned short crc, const unsigned char *buf, unsigned int len);
+
+// Private variables
+static unsigned char m_buf[LEN_MAX + 8];
+static int m_fails = 0;
+
+static unsigned short crc16_bitwise(const unsigned char *buf, unsigned int len) {
+	unsigned short crc = 0;
+
+	for (unsigned int i = 0;i < len;i++) {
+		crc ^= (unsigned short)buf[i] << 8;
+		for (int j = 0;j < 8;j++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+
+	return crc;
+}
+
+static void check(const char *name, unsigned short crc, unsigned short exp) {
+	if (crc != exp) {
+		printf("FAIL %s: 0x%04x, expected 0x%04x\n", name, crc, exp);
+		m_fails++;
+	}
+}
+
+static void test_conformance(void) {
+	// Check value of CRC-16/XMODEM
+	unsigned char check_str[] = "123456789";
+	check("check value table", crc16_table(check_str, 9), 0x31C3);
+	check("check value slice4", crc16_slice4(check_str, 9), 0x31C3);
+	check("empty", crc16_slice4(check_str, 0), 0);
+
+	srand(1);
+
+	for (int it = 0;it < ITERATIONS;it++) {
+		// Random lengths and start alignments, so that every tail length and
+		// unaligned buffers are covered
+		unsigned int len = rand() % (LEN_MAX + 1);
+		unsigned char *buf = m_buf + rand() % 8;
+
+		for (unsigned int i = 0;i < len;i++) {
+			buf[i] = (it & 1) ? rand() : (rand() % 2) * 0xFF;
+		}
+
+		unsigned short exp = crc16_bitwise(buf, len);
+		check("table", crc16_table(buf, len), exp);
+		check("slice4", crc16_slice4(buf, len), exp);
+
+		// Split into two updates
+		unsigned int split = len > 0 ? rand() % len : 0;
+		check("table update", crc16_update_table(
+				crc16_update_table(0, buf, split), buf + split, len - split), exp);
+		check("slice4 update", crc16_update_slice4(
+				crc16_update_slice4(0, buf, split), buf + split, len - split), exp);
+
+		if (m_fails > 10) {
+			break;
+		}
+	}
+}
+
+static void bench(const char *name, unsigned short (*func)(unsigned char*, unsigned int)) {
+	unsigned char buf[BENCH_LEN];
+	for (int i = 0;i < BENCH_LEN;i++) {
+		buf[i] = rand();
+	}
+
+	volatile unsigned short sink = 0;
+	clock_t start = clock();
+	for (int i = 0;i < (BENCH_BYTES / BENCH_LEN);i++) {
+		buf[0] = i;
+		sink ^= func(buf, BENCH_LEN);
+	}
+	double time = (double)(clock() - start) / CLOCKS_PER_SEC;
+	(void)sink;
+
+	printf("%-8s %8.1f MB/s\n", name, BENCH_BYTES / time / 1e6);
+}
+
+static unsigned short crc16_bitwise_bench(unsigned char *buf, unsigned int len) {
+	return crc16_bitwise(buf, len);
+}
+
+int main(int argc, char **argv) {
+	test_conformance();
+
+	if (m_fails > 0) {
+		printf("crc: %d failures\n", m_fails);
+		return 1;
+	}
+
+	printf("crc: OK\n");
+
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		printf("CRC16 of %d byte buffers:\n", BENCH_LEN);
+		bench("bitwise", crc16_bitwise_bench);
+		bench("table", crc16_table);
+		bench("slice4", crc16_slice4);
+	}
+
+	return 0;
+}
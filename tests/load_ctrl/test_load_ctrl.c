@@ -0,0 +1,294 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Host test harness of the automatic load control in load_ctrl.c. The
+ * controller runs at the ADC sample rate against a simulated bus: a
+ * capacitor that is charged by the regenerative current of the motor
+ * controllers, discharged by the resistor at the commanded duty cycle and
+ * held up by a battery that can supply current but not take any charge. The
+ * feed-forward current is sampled at the rate of the CAN status messages.
+ *
+ * Every regen profile is run with the linear map, the PI regulator and the PI
+ * regulator with feed-forward. The table shows how tightly the voltage is held
+ * and how much energy the resistor takes from the battery instead of from the
+ * regen. The PI modes are checked against fixed limits.
+ *
+ * test_load_ctrl      run all profiles and check the limits
+ * test_load_ctrl -v   also print the trace of every run as CSV
+ */
+
+#include "load_ctrl.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Simulation
+#define SIM_DT				1e-6 // Plant integration step
+#define CTRL_RATE			12500.0 // ADC sequences per second reaching fast_ctrl
+#define FF_RATE				100.0 // CAN status rate of the motor controllers
+#define SIM_TIME			2.0
+
+// Plant
+#ifndef BUS_C
+#define BUS_C				2.2e-3
+#endif
+#define BAT_V				36.0
+#define BAT_R				0.05
+#define LOAD_R				5.0
+
+// Configuration, the defaults except for the enabled load. BUS_C, PI_KP and
+// PI_KI can be overridden with -D to try other buses and gains.
+#define V_START				40.0
+#define V_MAX				50.0
+#define OUT_MAX				0.95
+#ifndef PI_KP
+#define PI_KP				0.2
+#endif
+#ifndef PI_KI
+#define PI_KI				15.0
+#endif
+#define FF_GAIN				0.9
+
+// Private types
+typedef enum {
+	MODE_LINEAR = 0,
+	MODE_PI,
+	MODE_PI_FF,
+	MODE_NUM
+} ctrl_mode;
+
+typedef struct {
+	const char *name;
+	float (*regen)(float t);
+	float settle_time; // Time after which the voltage has to be at the setpoint, 0 for none
+	float v_over_max; // Largest overshoot in the PI modes, 0 for no limit
+	float v_under_max; // Largest undershoot in the PI modes
+} profile;
+
+typedef struct {
+	float v_max;
+	float v_min_regen; // Lowest voltage while the regen is on, after the first crossing of the setpoint
+	float v_err_settled; // Largest setpoint error after settle_time
+	float e_regen; // Energy from regen
+	float e_res; // Energy dissipated in the resistor
+	float e_bat; // Energy the resistor took from the battery
+} result;
+
+// Private variables
+static const char *mode_names[MODE_NUM] = {"linear", "pi", "pi+ff"};
+static bool m_verbose = false;
+static int m_fails = 0;
+
+// Regen profiles
+static float regen_step(float t) {
+	return (t > 0.1 && t < 1.2) ? 5.0 : 0.0;
+}
+
+static float regen_ramp(float t) {
+	if (t < 0.1 || t > 1.5) {
+		return 0.0;
+	}
+
+	return t < 0.6 ? (t - 0.1) * 12.0 : 6.0 - (t - 0.6) * 6.0 / 0.9;
+}
+
+static float regen_pulses(float t) {
+	// Repeated hard braking, 4 Hz
+	if (t < 0.1 || t > 1.6) {
+		return 0.0;
+	}
+
+	return fmodf(t, 0.25) < 0.12 ? 6.5 : 1.0;
+}
+
+static float regen_sine(float t) {
+	if (t < 0.1 || t > 1.6) {
+		return 0.0;
+	}
+
+	return 3.0 + 2.5 * sinf(2.0 * M_PI * 7.0 * t);
+}
+
+static float regen_overload(float t) {
+	// More than the resistor can take, then back within its range. The
+	// integrator must not wind up during the overload.
+	if (t < 0.1 || t > 1.5) {
+		return 0.0;
+	}
+
+	return t < 0.5 ? 10.0 : 3.0;
+}
+
+static const profile profiles[] = {
+	{"step", regen_step, 0.3, 3.0, 0.5},
+	{"ramp", regen_ramp, 0.0, 0.5, 0.5},
+	{"pulses", regen_pulses, 0.0, 3.5, 3.5},
+	{"sine", regen_sine, 0.0, 1.5, 1.5},
+	{"overload", regen_overload, 0.8, 0.0, 0.5},
+};
+
+static result run(const profile *p, ctrl_mode mode) {
+	result r;
+	memset(&r, 0, sizeof(r));
+
+	float v = BAT_V;
+	float duty = 0.0;
+	float integral = 0.0;
+	bool pi_active = false;
+	float ff_current = 0.0;
+	float t_ctrl = 0.0;
+	float t_ff = 0.0;
+	bool crossed = false;
+
+	r.v_max = v;
+	r.v_min_regen = 1e9;
+
+	for (double t = 0.0;t < SIM_TIME;t += SIM_DT) {
+		float i_regen = p->regen(t);
+
+		if (t >= t_ff) {
+			ff_current = i_regen;
+			t_ff += 1.0 / FF_RATE;
+		}
+
+		if (t >= t_ctrl) {
+			float dt = 1.0 / CTRL_RATE;
+			float ff = mode == MODE_PI_FF ? load_ctrl_ff(ff_current, v, LOAD_R, FF_GAIN) : 0.0;
+
+			// Same as fast_ctrl in resistor.c, with the manual duty cycle at 0
+			if (mode == MODE_LINEAR) {
+				float out = load_ctrl_linear(v, V_START, V_MAX, OUT_MAX);
+				duty = out > 0.0 ? out : 0.0;
+			} else {
+				float out = load_ctrl_pi(&integral, v, V_START, PI_KP, PI_KI, dt, ff, OUT_MAX);
+				if (out > 0.0 || pi_active) {
+					duty = out;
+				}
+				pi_active = out > 0.0;
+			}
+
+			if (m_verbose) {
+				printf("%s,%s,%.5f,%.3f,%.3f,%.4f\n", p->name, mode_names[mode], t, i_regen, v, duty);
+			}
+
+			t_ctrl += dt;
+		}
+
+		// The battery supplies the bus below its voltage but cannot be charged
+		float i_bat = v < BAT_V ? (BAT_V - v) / BAT_R : 0.0;
+		float i_res = duty * v / LOAD_R;
+
+		v += (i_regen + i_bat - i_res) * SIM_DT / BUS_C;
+
+		r.e_regen += i_regen * v * SIM_DT;
+		r.e_res += i_res * v * SIM_DT;
+		r.e_bat += i_bat * v * SIM_DT;
+
+		if (v > r.v_max) {
+			r.v_max = v;
+		}
+
+		if (i_regen > 0.0 && v >= V_START) {
+			crossed = true;
+		}
+
+		if (i_regen > 0.0 && crossed && v < r.v_min_regen) {
+			r.v_min_regen = v;
+		}
+
+		if (p->settle_time > 0.0 && t > p->settle_time && i_regen > 0.0 &&
+				fabsf(v - (float)V_START) > r.v_err_settled) {
+			r.v_err_settled = fabsf(v - (float)V_START);
+		}
+	}
+
+	if (r.v_min_regen > 1e8) {
+		r.v_min_regen = r.v_max;
+	}
+
+	return r;
+}
+
+static void check(const char *what, const profile *p, ctrl_mode mode, float val, float limit) {
+	if (val > limit) {
+		printf("FAIL %s %s: %s %.3f, limit %.3f\n", p->name, mode_names[mode], what, val, limit);
+		m_fails++;
+	}
+}
+
+int main(int argc, char **argv) {
+	m_verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+	if (m_verbose) {
+		printf("profile,mode,t,i_regen,v,duty\n");
+	} else {
+		printf("%-9s %-7s %8s %8s %8s %9s %9s %9s\n", "profile", "mode",
+				"v_max", "v_min", "v_err", "e_regen", "e_res", "e_bat");
+	}
+
+	for (unsigned int i = 0;i < sizeof(profiles) / sizeof(profiles[0]);i++) {
+		const profile *p = &profiles[i];
+		result res[MODE_NUM];
+
+		for (int mode = 0;mode < MODE_NUM;mode++) {
+			res[mode] = run(p, mode);
+			result *r = &res[mode];
+
+			if (!m_verbose) {
+				printf("%-9s %-7s %8.2f %8.2f %8.3f %9.2f %9.2f %9.3f\n", p->name,
+						mode_names[mode], r->v_max, r->v_min_regen, r->v_err_settled,
+						r->e_regen, r->e_res, r->e_bat);
+			}
+
+			if (mode == MODE_LINEAR) {
+				continue;
+			}
+
+			// The steps in the profiles are instant, so the deviations are
+			// mostly set by the proportional gain
+			if (p->v_over_max > 0.0) {
+				check("overshoot", p, mode, r->v_max - V_START, p->v_over_max);
+			}
+			check("undershoot", p, mode, V_START - r->v_min_regen, p->v_under_max);
+			check("settled error", p, mode, r->v_err_settled, 0.05);
+
+			// Nearly all dissipated energy comes from the regen. A wound up
+			// integrator keeps the load on below the setpoint and drains the
+			// battery instead.
+			check("battery energy", p, mode, r->e_bat, 0.01 * r->e_res);
+		}
+
+		// Feed-forward reacts before the voltage has risen
+		if (p->regen == regen_step) {
+			check("ff overshoot", p, MODE_PI_FF,
+					res[MODE_PI_FF].v_max - V_START, res[MODE_PI].v_max - V_START);
+		}
+	}
+
+	if (m_fails > 0) {
+		printf("load_ctrl: %d failures\n", m_fails);
+		return 1;
+	}
+
+	printf("load_ctrl: OK\n");
+	return 0;
+}
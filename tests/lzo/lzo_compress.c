@@ -0,0 +1,195 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Host-side LZO1X compressor for the firmware upload with
+ * COMM_WRITE_NEW_APP_DATA_LZO. It uses a single hash table of previous
+ * positions and takes the first match it finds, which is enough for firmware
+ * images and is easy to follow. The output can be decompressed with lzo.c and
+ * with the lzo1x_decompress_safe of the LZO library.
+ */
+
+#include "lzo_compress.h"
+
+#include <string.h>
+
+// Settings
+#define HASH_BITS			14
+#define MATCH_LEN_MAX		2048
+
+#define M2_MAX_LEN			8
+#define M2_MAX_OFFSET		0x0800
+#define M3_MAX_OFFSET		0x4000
+#define M4_MAX_OFFSET		0xBFFF
+
+// Private types
+typedef struct {
+	uint8_t *out;
+	uint32_t len;
+	int state_ind; // Byte holding the count of the literals after the last match, -1 if none
+} lzo_writer;
+
+// Private functions
+static void put(lzo_writer *w, uint8_t b);
+static void put_count(lzo_writer *w, uint32_t count);
+static void put_literals(lzo_writer *w, const uint8_t *data, uint32_t len);
+static void put_match(lzo_writer *w, uint32_t len, uint32_t dist);
+
+/**
+ * Compress a buffer into one LZO1X block, including the end marker.
+ *
+ * @param in
+ * Data to compress.
+ *
+ * @param in_len
+ * Length of the data.
+ *
+ * @param out
+ * Buffer for the compressed data, at least LZO_COMPRESS_BOUND(in_len) bytes.
+ *
+ * @return
+ * Length of the compressed data.
+ */
+uint32_t lzo_compress(const uint8_t *in, uint32_t in_len, uint8_t *out) {
+	static int32_t head[1 << HASH_BITS];
+	lzo_writer w = {out, 0, -1};
+
+	for (int i = 0;i < (1 << HASH_BITS);i++) {
+		head[i] = -1;
+	}
+
+	uint32_t pos = 0;
+	uint32_t lit_start = 0;
+
+	while ((pos + 3) <= in_len) {
+		uint32_t key = (uint32_t)in[pos] << 16 | (uint32_t)in[pos + 1] << 8 | in[pos + 2];
+		uint32_t hash = (key * 2654435761u) >> (32 - HASH_BITS);
+		int32_t cand = head[hash];
+		head[hash] = pos;
+
+		uint32_t dist = pos - cand;
+
+		// An M4 distance of exactly 0x4000 would encode the end marker
+		if (cand < 0 || dist > M4_MAX_OFFSET || dist == M3_MAX_OFFSET ||
+				memcmp(in + cand, in + pos, 3) != 0) {
+			pos++;
+			continue;
+		}
+
+		uint32_t len = 3;
+		while ((pos + len) < in_len && len < MATCH_LEN_MAX &&
+				in[cand + len] == in[pos + len]) {
+			len++;
+		}
+
+		put_literals(&w, in + lit_start, pos - lit_start);
+		put_match(&w, len, dist);
+
+		pos += len;
+		lit_start = pos;
+	}
+
+	put_literals(&w, in + lit_start, in_len - lit_start);
+
+	// End marker, an M4 match with distance 0x4000
+	put(&w, 16 | 1);
+	put(&w, 0);
+	put(&w, 0);
+
+	return w.len;
+}
+
+static void put(lzo_writer *w, uint8_t b) {
+	w->out[w->len++] = b;
+}
+
+/*
+ * Counts that do not fit in the instruction are stored as a run of zero
+ * bytes that add 255 each, followed by the remainder.
+ */
+static void put_count(lzo_writer *w, uint32_t count) {
+	while (count > 255) {
+		put(w, 0);
+		count -= 255;
+	}
+
+	put(w, count);
+}
+
+static void put_literals(lzo_writer *w, const uint8_t *data, uint32_t len) {
+	if (len == 0) {
+		return;
+	}
+
+	if (w->len == 0) {
+		// The first instruction can hold up to 238 literals
+		if (len <= 238) {
+			put(w, 17 + len);
+		} else {
+			put(w, 0);
+			put_count(w, len - 18);
+		}
+	} else if (len <= 3 && w->state_ind >= 0) {
+		// Short runs after a match go in the low bits of the match
+		w->out[w->state_ind] |= len;
+	} else if (len <= 18) {
+		put(w, len - 3);
+	} else {
+		put(w, 0);
+		put_count(w, len - 18);
+	}
+
+	memcpy(w->out + w->len, data, len);
+	w->len += len;
+	w->state_ind = -1;
+}
+
+static void put_match(lzo_writer *w, uint32_t len, uint32_t dist) {
+	if (len <= M2_MAX_LEN && dist <= M2_MAX_OFFSET) {
+		dist -= 1;
+		w->state_ind = w->len;
+		put(w, ((len - 1) << 5) | ((dist & 7) << 2));
+		put(w, dist >> 3);
+		return;
+	}
+
+	if (dist <= M3_MAX_OFFSET) {
+		dist -= 1;
+		if ((len - 2) <= 31) {
+			put(w, 32 | (len - 2));
+		} else {
+			put(w, 32);
+			put_count(w, len - 2 - 31);
+		}
+	} else {
+		dist -= M3_MAX_OFFSET;
+		uint8_t high = ((dist >> 14) & 1) << 3;
+		if ((len - 2) <= 7) {
+			put(w, 16 | high | (len - 2));
+		} else {
+			put(w, 16 | high);
+			put_count(w, len - 2 - 7);
+		}
+		dist &= 0x3FFF;
+	}
+
+	w->state_ind = w->len;
+	put(w, (dist << 2) & 0xFF);
+	put(w, dist >> 6);
+}
@@ -0,0 +1,31 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef LZO_COMPRESS_H_
+#define LZO_COMPRESS_H_
+
+#include <stdint.h>
+
+// Worst case size of the compressed data
+#define LZO_COMPRESS_BOUND(len)		((len) + (len) / 16 + 64 + 3)
+
+// Functions
+uint32_t lzo_compress(const uint8_t *in, uint32_t in_len, uint8_t *out);
+
+#endif /* LZO_COMPRESS_H_ */
@@ -0,0 +1,132 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Compress an image for the upload with COMM_WRITE_NEW_APP_DATA_LZO.
+ *
+ * lzo_pack image.bin [out.bin] [chunk_size]
+ *
+ * The image is split into chunks of chunk_size bytes that are compressed
+ * separately, and every chunk is checked by decompressing it with lzo.c. The
+ * output file holds the payload of one COMM_WRITE_NEW_APP_DATA_LZO packet per
+ * chunk, without the command byte and preceded by its length:
+ *
+ * [len_hi, len_lo, offset (4 bytes), decompressed_len (2 bytes), data...]
+ *
+ * All numbers are big endian, as in the packets.
+ */
+
+#include "lzo.h"
+#include "lzo_compress.h"
+#include "packet.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Settings
+#define CHUNK_SIZE_DEFAULT		384
+#define PAYLOAD_HEADER_LEN		7 // Command byte, offset and decompressed length
+
+int main(int argc, char **argv) {
+	if (argc < 2 || argc > 4) {
+		printf("Usage: %s image.bin [out.bin] [chunk_size]\n", argv[0]);
+		return 1;
+	}
+
+	uint32_t chunk_size = argc > 3 ? (uint32_t)atoi(argv[3]) : CHUNK_SIZE_DEFAULT;
+	if (chunk_size == 0 || (chunk_size % 8) != 0 ||
+			LZO_COMPRESS_BOUND(chunk_size) > (PACKET_MAX_PL_LEN - PAYLOAD_HEADER_LEN)) {
+		printf("The chunk size must be a multiple of 8 that fits in a packet when compressed\n");
+		return 1;
+	}
+
+	FILE *f = fopen(argv[1], "rb");
+	if (!f) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	fseek(f, 0, SEEK_END);
+	long image_len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint8_t *image = malloc(image_len > 0 ? image_len : 1);
+	if (fread(image, 1, image_len, f) != (size_t)image_len) {
+		perror(argv[1]);
+		return 1;
+	}
+	fclose(f);
+
+	FILE *out = 0;
+	if (argc > 2) {
+		out = fopen(argv[2], "wb");
+		if (!out) {
+			perror(argv[2]);
+			return 1;
+		}
+	}
+
+	uint8_t comp[LZO_COMPRESS_BOUND(PACKET_MAX_PL_LEN)];
+	uint8_t check[PACKET_MAX_PL_LEN];
+	uint32_t comp_total = 0;
+	uint32_t chunks = 0;
+
+	for (uint32_t offset = 0;offset < (uint32_t)image_len;offset += chunk_size) {
+		uint32_t len = (uint32_t)image_len - offset;
+		if (len > chunk_size) {
+			len = chunk_size;
+		}
+
+		uint32_t comp_len = lzo_compress(image + offset, len, comp);
+
+		uint32_t check_len = sizeof(check);
+		if (lzo_decompress(comp, comp_len, check, &check_len) != LZO_E_OK ||
+				check_len != len || memcmp(check, image + offset, len) != 0) {
+			printf("Chunk at %u does not decompress to the image\n", offset);
+			return 1;
+		}
+
+		if (out) {
+			uint32_t rec_len = PAYLOAD_HEADER_LEN - 1 + comp_len;
+			uint8_t header[8] = {
+					rec_len >> 8, rec_len,
+					offset >> 24, offset >> 16, offset >> 8, offset,
+					len >> 8, len
+			};
+			fwrite(header, 1, sizeof(header), out);
+			fwrite(comp, 1, comp_len, out);
+		}
+
+		comp_total += comp_len + PAYLOAD_HEADER_LEN;
+		chunks++;
+	}
+
+	if (out) {
+		fclose(out);
+	}
+
+	printf("Chunks:     %u\n", chunks);
+	printf("Image:      %ld bytes\n", image_len);
+	printf("Compressed: %u bytes including packet headers (%.1f %%)\n",
+			comp_total, image_len > 0 ? 100.0 * comp_total / image_len : 0.0);
+
+	free(image);
+	return 0;
+}
@@ -0,0 +1,225 @@
+/*
+	Copyright 2022 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC BMS firmware.
+
+	The VESC BMS firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC BMS firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+/*
+ * Host test of lzo.c. Round-trips generated data through lzo_compress,
+ * decodes hand-built streams that use the instructions the compressor never
+ * emits, and checks that truncated and corrupted streams and too small output
+ * buffers fail without touching memory outside of the buffers. Build with
+ * AddressSanitizer, as in the Makefile, so that any stray access is caught.
+ */
+
+#include "lzo.h"
+#include "lzo_compress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Settings
+#define ITERATIONS			20000
+#define LEN_MAX				65000
+
+// Private variables
+static uint8_t m_in[LEN_MAX];
+static uint8_t m_comp[LZO_COMPRESS_BOUND(LEN_MAX)];
+static uint8_t m_out[LEN_MAX];
+static int m_fails = 0;
+
+static void fail(const char *name, int res, uint32_t len, uint32_t len_exp) {
+	printf("FAIL %s: res %d, len %u, expected %u\n", name, res, len, len_exp);
+	m_fails++;
+}
+
+/*
+ * Decode from an exact size heap copy of the stream, so that reading past
+ * its end is reported.
+ */
+static int decode(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t *out_len) {
+	uint8_t *copy = malloc(in_len > 0 ? in_len : 1);
+	memcpy(copy, in, in_len);
+	int res = lzo_decompress(copy, in_len, out, out_len);
+	free(copy);
+	return res;
+}
+
+static void check(const char *name, const uint8_t *in, uint32_t in_len,
+		const uint8_t *exp, uint32_t exp_len) {
+	uint32_t len = sizeof(m_out);
+	int res = decode(in, in_len, m_out, &len);
+
+	if (res != LZO_E_OK || len != exp_len || memcmp(m_out, exp, exp_len) != 0) {
+		fail(name, res, len, exp_len);
+	}
+}
+
+static void check_error(const char *name, const uint8_t *in, uint32_t in_len, int res_exp) {
+	uint32_t len = sizeof(m_out);
+	int res = decode(in, in_len, m_out, &len);
+
+	if (res != res_exp) {
+		fail(name, res, len, 0);
+	}
+}
+
+static void fill(uint32_t len, int mode) {
+	for (uint32_t i = 0;i < len;i++) {
+		switch (mode) {
+		case 0: // Random
+			m_in[i] = rand();
+			break;
+
+		case 1: // Few symbols
+			m_in[i] = rand() % 4;
+			break;
+
+		case 2: // Short distances
+			m_in[i] = (i > 20 && rand() % 8) ? m_in[i - 1 - rand() % 20] : rand();
+			break;
+
+		default: // Long runs and distances beyond 16 KiB
+			if (i > 20000 && rand() % 4) {
+				m_in[i] = m_in[i - 17000 - rand() % 3];
+			} else {
+				m_in[i] = (i > 0 && rand() % 3) ? m_in[i - 1] : rand();
+			}
+			break;
+		}
+	}
+}
+
+static void test_hand_built(void) {
+	// Empty stream, only the end marker
+	const uint8_t empty[] = {0x11, 0, 0};
+	check("empty", empty, sizeof(empty), (const uint8_t*)"", 0);
+
+	// Three literals in the first instruction, then a two byte M1 match at
+	// distance 3
+	const uint8_t m1[] = {17 + 3, 'a', 'b', 'c', 2 << 2, 0, 0x11, 0, 0};
+	check("m1", m1, sizeof(m1), (const uint8_t*)"abcab", 5);
+
+	// Long first literal run and the three byte match at distance 2049 that
+	// only follows literal runs
+	static uint8_t stream[2200];
+	static uint8_t exp[2200];
+	uint32_t n = 0;
+
+	for (int i = 0;i < 2100;i++) {
+		exp[i] = rand();
+	}
+	memcpy(exp + 2100, exp + 2100 - 2049, 3);
+
+	stream[n++] = 0;
+	uint32_t count = 2100 - 18;
+	while (count > 255) {
+		stream[n++] = 0;
+		count -= 255;
+	}
+	stream[n++] = count;
+	memcpy(stream + n, exp, 2100);
+	n += 2100;
+	stream[n++] = 0;
+	stream[n++] = 0;
+	stream[n++] = 0x11;
+	stream[n++] = 0;
+	stream[n++] = 0;
+	check("m1 after literals", stream, n, exp, 2103);
+
+	// Matches before the start of the output
+	const uint8_t lb[] = {17 + 1, 'a', (8 - 1) << 5, 1, 0x11, 0, 0};
+	check_error("lookbehind", lb, sizeof(lb), LZO_E_LOOKBEHIND_OVERRUN);
+
+	// Data after the end marker
+	const uint8_t trailing[] = {0x11, 0, 0, 0};
+	check_error("trailing", trailing, sizeof(trailing), LZO_E_INPUT_NOT_CONSUMED);
+
+	// No end marker
+	const uint8_t no_end[] = {17 + 3, 'a', 'b', 'c'};
+	check_error("no end", no_end, sizeof(no_end), LZO_E_INPUT_OVERRUN);
+
+	// Endless zero count
+	const uint8_t zeros[] = {0, 0, 0, 0, 0, 0, 0, 0};
+	check_error("zeros", zeros, sizeof(zeros), LZO_E_INPUT_OVERRUN);
+}
+
+static void test_round_trip(void) {
+	for (int it = 0;it < ITERATIONS;it++) {
+		uint32_t len = rand() % (it < (ITERATIONS * 85 / 100) ? 600 : LEN_MAX);
+		fill(len, rand() % 4);
+
+		uint32_t comp_len = lzo_compress(m_in, len, m_comp);
+		if (comp_len > LZO_COMPRESS_BOUND(len)) {
+			fail("bound", 0, comp_len, LZO_COMPRESS_BOUND(len));
+		}
+
+		check("round trip", m_comp, comp_len, m_in, len);
+
+		// Too small output buffer, exactly sized so that overruns are caught
+		if (len > 0) {
+			uint32_t out_len = len - 1;
+			uint8_t *out = malloc(out_len > 0 ? out_len : 1);
+			int res = lzo_decompress(m_comp, comp_len, out, &out_len);
+			free(out);
+
+			if (res != LZO_E_OUTPUT_OVERRUN) {
+				fail("small output", res, out_len, len - 1);
+			}
+		}
+
+		for (int i = 0;i < 5;i++) {
+			// Truncated. Any result is fine as long as nothing outside of the
+			// buffers is accessed, and a shorter stream cannot be complete.
+			uint32_t trunc_len = rand() % (comp_len + 1);
+			if (trunc_len < comp_len) {
+				uint32_t out_len = sizeof(m_out);
+				int res = decode(m_comp, trunc_len, m_out, &out_len);
+
+				if (res == LZO_E_OK && out_len == len) {
+					fail("truncated", res, out_len, len);
+				}
+			}
+
+			// Bit flip, decoded into an exact size output buffer
+			uint8_t *corrupt = malloc(comp_len);
+			memcpy(corrupt, m_comp, comp_len);
+			corrupt[rand() % comp_len] ^= 1 << (rand() % 8);
+
+			uint32_t out_len = len;
+			uint8_t *out = malloc(out_len > 0 ? out_len : 1);
+			lzo_decompress(corrupt, comp_len, out, &out_len);
+			free(corrupt);
+			free(out);
+		}
+	}
+}
+
+int main(void) {
+	srand(1);
+
+	test_hand_built();
+	test_round_trip();
+
+	if (m_fails > 0) {
+		printf("lzo: %d failures\n", m_fails);
+		return 1;
+	}
+
+	printf("lzo: OK\n");
+	return 0;
+}